@@ -0,0 +1,14 @@
+#ifndef _ALLOCATION_COUNTER_HPP_
+#define _ALLOCATION_COUNTER_HPP_
+
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Number of operator new calls made by the calling thread.  Only counted in executables that link
+	// allocation_counter.cpp, which replaces the global operator new to call CountThreadAllocation().
+	uint64_t GetThreadAllocationCount();
+	void CountThreadAllocation();
+}
+
+#endif
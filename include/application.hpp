@@ -1,10 +1,15 @@
 #ifndef _APPLICATION_HPP_
 #define _APPLICATION_HPP_
 
+#include "types.hpp"
+#include "diagnostics.hpp"
+#include "glyph_cache.hpp"
+#include "assembler.hpp"
+#include "include_cache.hpp"
+#include "emitter.hpp"
 #include <string>
-#include <array>
 #include <vector>
-#include <memory>
+#include <cstdio>
 #include <cstdint>
 
 namespace MisbitFontAssembler
@@ -15,48 +20,10 @@ namespace MisbitFontAssembler
 		uint16_t minor;
 	};
 
-	struct FontSizeData
+	struct AssemblyJob
 	{
-		uint16_t width;
-		uint16_t height;
-	};
-
-	struct DrawCoordinates
-	{
-		uint16_t x;
-		uint16_t y;
-	};
-
-	struct FontCharacterData
-	{
-		std::vector<uint8_t> character;
-		uint16_t width; // Used only with Variable Spacing.
-	};
-
-	enum class TokenType
-	{
-		None, CurrentFontWidth, Draw, DrawMode, FontName, Language, MaxFontSize, PaletteFormat,
-		SpacingType
-	};
-
-	enum class ErrorType
-	{
-		NoError, InvalidToken, MissingOperand, InvalidValue, IllegalToken, UnsupportedPaletteFormat,
-		UnsupportedMaxFontSize, StringRequirement
-	};
-
-	enum class DrawMode
-	{
-		Binary,
-		Octal,
-		Decimal,
-		Hexadecimal
-	};
-
-	enum class SpacingType
-	{
-		Monospace,
-		Variable
+		std::string input_path;
+		std::string output_path;
 	};
 
 	class Application
@@ -68,35 +35,30 @@ namespace MisbitFontAssembler
 			bool GetExit() const;
 			int GetReturnCode() const;
 		private:
-			size_t current_line_number;
-			size_t error_count;
-			size_t warning_count;
+			void PrintFormat() const;
+			bool ParseArguments();
+			void Watch();
+			std::string GetCachePath(const std::string &input_path) const;
+			bool AssembleFile(const AssemblyJob &Job, Assembler &JobAssembler, Diagnostics &JobDiagnostics);
+			void ReportDuplicates(const FontData &Font, Diagnostics &JobDiagnostics) const;
+
 			std::vector<std::string> Args;
-			const std::array<std::string, 8> TokenList = {
-				"CURRENT_FONT_WIDTH", "DRAW", "DRAW_MODE", "FONT_NAME", "LANGUAGE",
-				"MAX_FONT_SIZE", "PALETTE_FORMAT", "SPACING_TYPE"
-			};
-			const std::array<std::string, 4> DrawModeList = {
-				"BINARY", "OCTAL", "DECIMAL", "HEXADECIMAL"
-			};
-			const std::array<std::string, 2> SpacingTypeList = {
-				"MONOSPACE", "VARIABLE"
-			};
-			const std::array<std::string, 2> ToggleList = {
-				"OFF", "ON"
-			};
+			std::vector<AssemblyJob> Jobs;
+			DiagnosticsOptions JobDiagnosticsOptions;
+			OutputFormat output_format;
+			std::string cache_directory;
+			GlyphCache WatchCache;
+			IncludeCache Includes; // Shared by every job, so an include is parsed once per run.
 			const VersionData Version = { 0, 1 };
-			DrawMode current_draw_mode;
-			uint8_t palette_format;
-			FontSizeData current_max_font_size;
-			DrawCoordinates current_draw_coordinates;
-			uint16_t current_font_width;
-			std::string font_name;
-			std::string language;
-			SpacingType current_spacing_type;
-			FontCharacterData CurrentFontCharacter;
-			std::vector<FontCharacterData> FontCharacterTable;
-			bool draw;
+			std::FILE *console;
+			size_t thread_count;
+			size_t decode_thread_count;
+			bool batch;
+			bool stream;
+			bool stats;
+			bool watch;
+			bool dedupe_report;
+			bool from_bdf;
 			bool exit;
 			int retcode;
 	};
@@ -0,0 +1,77 @@
+#ifndef _ASSEMBLER_HPP_
+#define _ASSEMBLER_HPP_
+
+#include "types.hpp"
+#include "parser.hpp"
+#include "bdf_importer.hpp"
+#include "emitter.hpp"
+#include "diagnostics.hpp"
+#include "input_reader.hpp"
+#include "glyph_cache.hpp"
+#include "include_cache.hpp"
+#include "statistics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum class InputFormat
+	{
+		Source, // MisbitFont Assembler source.
+		Bdf // BDF bitmap font, imported by the BdfImporter.
+	};
+
+	struct AssemblerOptions
+	{
+		DiagnosticsOptions Reporting;
+		InputFormat input_format = InputFormat::Source;
+		std::string_view source_name; // The file named by JSON diagnostics, which includes are relative to.
+		bool file_access = false; // Lets include and import_sheet open files; an error otherwise.
+		size_t decode_thread_count = 1;
+		GlyphCache *Cache = nullptr;
+		IncludeCache *Includes = nullptr;
+		Statistics *Stats = nullptr;
+	};
+
+	struct AssemblyResult
+	{
+		std::vector<uint8_t> Bytes; // The MisbitFont file, empty unless the assembly succeeded.
+		std::string diagnostics;
+		size_t character_count = 0;
+		size_t error_count = 0;
+		size_t warning_count = 0;
+		bool success = false;
+	};
+
+	// Assembles a source held in memory into a MisbitFont file held in memory, without touching the
+	// console.  The file system is not touched either unless file_access is set in the options: include
+	// and import_sheet are errors otherwise, since a source could name any file the process can read.
+	// Assemblers share no state, so any number of them can run on different threads.  Each one keeps its
+	// buffers between calls, so once they have grown assembling another font allocates next to nothing;
+	// the result of Assemble() stays valid until the next call.  Parse() is the part shared with the
+	// command line front end, which reads files and writes the FontData itself.  To only decode the
+	// characters changed since the previous assembly, pass the same GlyphCache each time and call its
+	// Advance() in between.  A BDF font can be given instead of a source, which goes through the same
+	// packing and writing.
+	class Assembler
+	{
+		public:
+			Assembler();
+			const AssemblyResult &Assemble(std::string_view source, const AssemblerOptions &Options = {});
+			bool Parse(InputReader &Input, Diagnostics &SourceDiagnostics, const AssemblerOptions &Options, StreamEmitter *Stream = nullptr);
+			const FontData &GetFontData() const;
+			bool IsCacheUpdated() const;
+		private:
+			InputReader SourceReader;
+			Diagnostics AssemblyDiagnostics;
+			Parser SourceParser;
+			BdfImporter FontImporter;
+			AssemblyResult Result;
+			bool cache_updated;
+			bool imported;
+	};
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _BDF_IMPORTER_HPP_
+#define _BDF_IMPORTER_HPP_
+
+#include "types.hpp"
+#include "glyph_arena.hpp"
+#include "diagnostics.hpp"
+#include "input_reader.hpp"
+#include "statistics.hpp"
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	class StreamEmitter;
+
+	// Builds the FontData IR from a BDF bitmap font read line by line, so the font is never held in memory
+	// as text.  FONTBOUNDINGBOX becomes the max font size, every character's BBX is placed inside it
+	// relative to the baseline, and with proportional spacing (the SPACING property) each character's
+	// width is taken from its DWIDTH.  Characters are added in the order they appear, one bit per pixel.
+	class BdfImporter
+	{
+		public:
+			BdfImporter();
+			void Import(InputReader &input, Diagnostics &diagnostics, StreamEmitter *Stream = nullptr, Statistics *Stats = nullptr);
+			const FontData &GetFontData() const;
+		private:
+			void ParseLine(std::string_view line);
+			void DecodeBitmapRow(std::string_view line);
+			void EndCharacter();
+			void Warning(size_t column, WarningType warning_type);
+			void Error(size_t column, ErrorType error_type, std::string_view token = "");
+
+			Diagnostics *ImportDiagnostics;
+			StreamEmitter *Stream;
+			Statistics *Stats;
+			FontData Font;
+			std::vector<uint8_t> Character; // Decoded pixels, max font width by max font height.
+			size_t current_line_number;
+			int32_t box_x; // FONTBOUNDINGBOX offsets from the origin, the cell's left edge and bottom.
+			int32_t box_y;
+			int32_t glyph_width; // The current character's BBX.
+			int32_t glyph_height;
+			int32_t glyph_x;
+			int32_t glyph_y;
+			int32_t device_width; // DWIDTH, the distance from the origin to the next character's.
+			int32_t default_device_width;
+			int32_t bitmap_row;
+			bool bounding_box_seen;
+			bool font_started;
+			bool font_ended;
+			bool character_started;
+			bool bitmap;
+	};
+}
+
+#endif
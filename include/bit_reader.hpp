@@ -0,0 +1,138 @@
+#ifndef _BIT_READER_HPP_
+#define _BIT_READER_HPP_
+
+#include <array>
+#include <cstring>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Unpacks fixed-width values MSB first, the counterpart of BitWriter.  Bytes are only fetched as they
+	// are needed, so reading never goes past the byte holding the last value read.
+	template <uint8_t Bits>
+	class BitReader
+	{
+		public:
+			static_assert(Bits >= 1 && Bits <= 8, "BitReader only supports palette formats 1 through 8.");
+
+			BitReader(const uint8_t *input, size_t bit_offset = 0) : input(input + (bit_offset / 8)), accumulator(0), bit_count(0)
+			{
+				if (bit_offset % 8)
+				{
+					accumulator = *this->input++;
+					bit_count = static_cast<uint8_t>(8 - (bit_offset % 8));
+				}
+			}
+
+			uint8_t Read()
+			{
+				if (bit_count < Bits)
+				{
+					accumulator = (accumulator << 8) | *input++;
+					bit_count += 8;
+				}
+				bit_count -= Bits;
+				return static_cast<uint8_t>((accumulator >> bit_count) & ((1u << Bits) - 1));
+			}
+		private:
+			const uint8_t *input;
+			uint32_t accumulator;
+			uint8_t bit_count;
+	};
+
+	// One byte of 1-bit pixels spread over 8 bytes, as they are laid out in memory.
+	inline constexpr std::array<uint64_t, 256> SpreadBits = []()
+	{
+		std::array<uint64_t, 256> Table {};
+		for (size_t value = 0; value < Table.size(); ++value)
+		{
+			uint8_t bytes[8] = {};
+			for (size_t bit = 0; bit < 8; ++bit)
+			{
+				bytes[bit] = (value >> (7 - bit)) & 1;
+			}
+			for (size_t i = 0; i < 8; ++i)
+			{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				Table[value] |= static_cast<uint64_t>(bytes[i]) << (56 - (i * 8));
+#else
+				Table[value] |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+#endif
+			}
+		}
+		return Table;
+	}();
+
+	template <uint8_t Bits>
+	void UnpackPixels(const uint8_t *input, size_t bit_offset, size_t pixel_count, uint8_t *pixels)
+	{
+		size_t p = 0;
+		if constexpr (Bits == 1)
+		{
+			if (bit_offset % 8 == 0)
+			{
+				const uint8_t *bytes = input + (bit_offset / 8);
+				for (; p + 8 <= pixel_count; p += 8)
+				{
+					memcpy(pixels + p, &SpreadBits[*bytes++], 8);
+				}
+				bit_offset += p;
+			}
+		}
+		BitReader<Bits> Reader(input, bit_offset);
+		for (; p < pixel_count; ++p)
+		{
+			pixels[p] = Reader.Read();
+		}
+	}
+
+	// Unpacks palette_format bits per pixel, starting at bit_offset within input, into one pixel per byte.
+	inline void UnpackPixels(uint8_t palette_format, const uint8_t *input, size_t bit_offset, size_t pixel_count, uint8_t *pixels)
+	{
+		switch (palette_format)
+		{
+			case 1:
+			{
+				UnpackPixels<1>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 2:
+			{
+				UnpackPixels<2>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 3:
+			{
+				UnpackPixels<3>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 4:
+			{
+				UnpackPixels<4>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 5:
+			{
+				UnpackPixels<5>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 6:
+			{
+				UnpackPixels<6>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 7:
+			{
+				UnpackPixels<7>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+			case 8:
+			{
+				UnpackPixels<8>(input, bit_offset, pixel_count, pixels);
+				break;
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef _BIT_WRITER_HPP_
+#define _BIT_WRITER_HPP_
+
+#include <cstring>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Packs fixed-width values MSB first, the bit order used by MisbitFont's font data.  Values are
+	// accumulated in a 64-bit register and stored a whole word at a time.  Writing may start at any bit
+	// offset; bits already in the first partial byte are preserved.
+	template <uint8_t Bits>
+	class BitWriter
+	{
+		public:
+			static_assert(Bits >= 1 && Bits <= 8, "BitWriter only supports palette formats 1 through 8.");
+
+			BitWriter(uint8_t *output, size_t bit_offset = 0) : output(output + (bit_offset / 8)), accumulator(0), bit_count(static_cast<uint8_t>(bit_offset % 8))
+			{
+				if (bit_count)
+				{
+					accumulator = static_cast<uint64_t>(this->output[0] & (0xFF << (8 - bit_count))) << 56;
+				}
+			}
+
+			void Write(uint8_t value)
+			{
+				uint64_t bits = value & ((1u << Bits) - 1);
+				uint8_t total = bit_count + Bits;
+				if (total < 64)
+				{
+					accumulator |= bits << (64 - total);
+					bit_count = total;
+				}
+				else
+				{
+					uint8_t spill = total - 64;
+					accumulator |= bits >> spill;
+					StoreWord();
+					accumulator = spill ? (bits << (64 - spill)) : 0;
+					bit_count = spill;
+				}
+			}
+
+			void Skip(size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					Write(0);
+				}
+			}
+
+			// Stores the remaining partial word.  Must be called once writing is done.
+			void Flush()
+			{
+				for (uint8_t shift = 56; bit_count > 0; shift -= 8)
+				{
+					*output++ = static_cast<uint8_t>(accumulator >> shift);
+					bit_count = (bit_count > 8) ? bit_count - 8 : 0;
+				}
+				accumulator = 0;
+			}
+		private:
+			void StoreWord()
+			{
+				uint64_t word = accumulator;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+				word = __builtin_bswap64(word);
+#elif !defined(__GNUC__)
+				uint8_t bytes[8];
+				for (int i = 0; i < 8; ++i)
+				{
+					bytes[i] = static_cast<uint8_t>(accumulator >> (56 - (i * 8)));
+				}
+				memcpy(&word, bytes, sizeof(word));
+#endif
+				memcpy(output, &word, sizeof(word));
+				output += 8;
+			}
+
+			uint8_t *output;
+			uint64_t accumulator;
+			uint8_t bit_count;
+	};
+
+	template <uint8_t Bits>
+	void PackPixels(const uint8_t *pixels, size_t pixel_count, uint8_t *output, size_t bit_offset)
+	{
+		if constexpr (Bits == 8)
+		{
+			// 8-bit pixels always start on a byte boundary and are stored as they are.
+			if (bit_offset % 8 == 0)
+			{
+				memcpy(output + (bit_offset / 8), pixels, pixel_count);
+				return;
+			}
+		}
+		BitWriter<Bits> Writer(output, bit_offset);
+		for (size_t p = 0; p < pixel_count; ++p)
+		{
+			Writer.Write(pixels[p]);
+		}
+		Writer.Flush();
+	}
+
+	// Packs one pixel per byte into palette_format bits per pixel, starting at bit_offset within output.
+	inline void PackPixels(uint8_t palette_format, const uint8_t *pixels, size_t pixel_count, uint8_t *output, size_t bit_offset = 0)
+	{
+		switch (palette_format)
+		{
+			case 1:
+			{
+				PackPixels<1>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 2:
+			{
+				PackPixels<2>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 3:
+			{
+				PackPixels<3>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 4:
+			{
+				PackPixels<4>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 5:
+			{
+				PackPixels<5>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 6:
+			{
+				PackPixels<6>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 7:
+			{
+				PackPixels<7>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+			case 8:
+			{
+				PackPixels<8>(pixels, pixel_count, output, bit_offset);
+				break;
+			}
+		}
+	}
+}
+
+#endif
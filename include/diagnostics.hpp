@@ -0,0 +1,64 @@
+#ifndef _DIAGNOSTICS_HPP_
+#define _DIAGNOSTICS_HPP_
+
+#include "types.hpp"
+#include <string>
+#include <string_view>
+#include <array>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <fmt/format.h>
+
+namespace MisbitFontAssembler
+{
+	enum class DiagnosticsFormat
+	{
+		Text,
+		Json
+	};
+
+	struct DiagnosticsOptions
+	{
+		DiagnosticsFormat format = DiagnosticsFormat::Text;
+		size_t max_warnings = std::numeric_limits<size_t>::max();
+	};
+
+	// Collects the messages of a single assembly so they can be written out together.  A warning of the
+	// same kind on the same line as the previous one is only counted, as are warnings beyond
+	// max_warnings; Summarize() reports how many of each kind were not shown.  In the Json format every
+	// message is written as a single line JSON object instead.  Warnings and errors from an included
+	// file are reported against that file.
+	class Diagnostics
+	{
+		public:
+			Diagnostics(const DiagnosticsOptions &Options = {}, std::string_view file = "");
+			void Message(std::string_view message);
+			void Warning(size_t line, size_t column, WarningType warning_type, DrawMode draw_mode = DrawMode::Binary);
+			void Error(size_t line, size_t column, ErrorType error_type, TokenType token_type, std::string_view token);
+			void Summarize(bool success);
+			void Reset(size_t output_size = 0);
+			void Reset(const DiagnosticsOptions &Options, std::string_view file);
+			void SetIncludedFile(std::string_view included_file);
+			size_t GetErrorCount() const;
+			size_t GetWarningCount() const;
+			size_t GetOutputSize() const;
+			std::string_view GetOutput() const;
+			void Flush(std::FILE *stream = stdout);
+		private:
+			std::string GetLocationPrefix() const;
+			void WriteJson(std::string_view type, std::string_view kind, size_t line, size_t column, std::string_view message);
+
+			fmt::memory_buffer Output;
+			DiagnosticsOptions Options;
+			std::string file;
+			std::string included_file;
+			std::array<size_t, static_cast<size_t>(WarningType::Count)> LastWarningLine;
+			std::array<size_t, static_cast<size_t>(WarningType::Count)> SuppressedWarnings;
+			size_t error_count;
+			size_t warning_count;
+			size_t shown_warning_count;
+	};
+}
+
+#endif
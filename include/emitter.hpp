@@ -0,0 +1,61 @@
+#ifndef _EMITTER_HPP_
+#define _EMITTER_HPP_
+
+#include "types.hpp"
+#include "glyph_arena.hpp"
+#include "statistics.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum class OutputFormat
+	{
+		MisbitFont,
+		CxxHeader
+	};
+
+	// Writes the FontData IR out as a MisbitFont file, using libmsbtfont for the header.  The path '-'
+	// writes to standard output.  The file can also be written to memory, reusing the capacity of Output.
+	// WriteCxxHeader() writes the same bytes as a C++ header instead, as constexpr arrays in a namespace
+	// named after name, along with constexpr accessors, so a font can be compiled into a program.
+	class Emitter
+	{
+		public:
+			Emitter(Statistics *Stats = nullptr);
+			bool Write(const FontData &Font, const std::string &path);
+			void Write(const FontData &Font, std::vector<uint8_t> &Output);
+			bool WriteCxxHeader(const FontData &Font, const std::string &path, std::string_view name);
+		private:
+			Statistics *Stats;
+	};
+
+	// Writes characters out as they are assembled so memory use does not grow with the character count.
+	// A placeholder header is written first and replaced once assembly is done, so the output has to be
+	// seekable.  With Variable spacing the font data is spilled to a temporary file until the variable
+	// table is complete.
+	class StreamEmitter
+	{
+		public:
+			StreamEmitter(Statistics *Stats = nullptr);
+			~StreamEmitter();
+			bool Open(const std::string &path);
+			void WriteCharacters(FontData &Font);
+			bool Finish(const FontData &Font);
+			void Discard();
+		private:
+			void WriteOutput(const void *data, size_t size);
+
+			Statistics *Stats;
+			std::ofstream OutputFile;
+			std::string path;
+			std::FILE *font_data_spill;
+			bool good;
+	};
+}
+
+#endif
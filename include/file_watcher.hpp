@@ -0,0 +1,28 @@
+#ifndef _FILE_WATCHER_HPP_
+#define _FILE_WATCHER_HPP_
+
+#include <string>
+#include <filesystem>
+
+namespace MisbitFontAssembler
+{
+	// Blocks until a file is changed.  The directory is watched rather than the file itself, since many
+	// editors save by replacing the file.  Uses inotify where available and polls the modification time
+	// otherwise.
+	class FileWatcher
+	{
+		public:
+			FileWatcher();
+			~FileWatcher();
+			FileWatcher(const FileWatcher &) = delete;
+			FileWatcher &operator=(const FileWatcher &) = delete;
+			bool Open(const std::string &path);
+			bool Wait();
+		private:
+			std::filesystem::path file_path;
+			std::filesystem::file_time_type last_write_time;
+			int inotify_descriptor;
+	};
+}
+
+#endif
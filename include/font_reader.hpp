@@ -0,0 +1,49 @@
+#ifndef _FONT_READER_HPP_
+#define _FONT_READER_HPP_
+
+#include "types.hpp"
+#include "mapped_file.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum class FontReadResult
+	{
+		Success,
+		OpenFailed,
+		InvalidHeader,
+		Truncated
+	};
+
+	// Reads a MisbitFont file in place: the file is memory mapped where possible (and read whole
+	// otherwise), and the variable table and font data are used straight from it.  The header is only
+	// accepted if libmsbtfont recreates it byte for byte from the values read out of it.
+	class FontReader
+	{
+		public:
+			FontReader();
+			~FontReader();
+			FontReader(const FontReader &) = delete;
+			FontReader &operator=(const FontReader &) = delete;
+			FontReadResult Open(const std::string &path);
+			void Close();
+			const FontSettings &GetSettings() const;
+			uint32_t GetCount() const;
+			size_t GetCharacterBits() const;
+			bool HasTrailingData() const;
+			uint16_t GetWidth(uint32_t index) const;
+			void UnpackCharacter(uint32_t index, uint8_t *pixels) const;
+		private:
+			FontSettings Settings;
+			MappedFile File;
+			const uint8_t *variable_table;
+			const uint8_t *font_data;
+			size_t character_bits;
+			bool trailing_data;
+			uint32_t count;
+	};
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _GLYPH_ARENA_HPP_
+#define _GLYPH_ARENA_HPP_
+
+#include "types.hpp"
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Holds every assembled character exactly as it is laid out in a MisbitFont file: the variable table
+	// (one width - 1 byte per character) and the font data, where each character directly follows the
+	// previous one bit for bit.  Characters are packed straight into place, so the arena is written out
+	// as is.  When streaming, Release() drops what has already been written, keeping only the partial
+	// last byte.  Characters decoded out of order are added with Reserve() and packed later with Store(),
+	// which may run concurrently for different characters.  Characters still held, which after Release()
+	// includes a copy of the last one, can be copied out again with CopyPacked().  Clear() empties the
+	// arena for another font while keeping its memory.  The character count is stored as 32 bits, so a
+	// full arena refuses to grow: Append() and Reserve() then return MaxCount without adding anything.
+	class GlyphArena
+	{
+		public:
+			static constexpr uint32_t MaxCount = std::numeric_limits<uint32_t>::max();
+
+			GlyphArena();
+			void Configure(const FontSettings &Settings);
+			uint32_t Append(const uint8_t *pixels, uint16_t width);
+			uint32_t Reserve(uint16_t width);
+			void Store(uint32_t index, const uint8_t *pixels);
+			void StorePacked(uint32_t index, const uint8_t *packed);
+			void CopyPacked(uint32_t index, uint8_t *packed) const;
+			bool HasRoom(uint64_t added) const;
+			bool IsHeld(uint32_t index) const;
+			uint16_t GetWidth(uint32_t index) const;
+			uint32_t GetCount() const;
+			size_t GetCharacterBits() const;
+			size_t GetFontDataSize() const;
+			size_t GetCompleteFontDataSize() const;
+			size_t GetVariableTableSize() const;
+			const uint8_t *GetFontData() const;
+			const uint8_t *GetVariableTable() const;
+			void Release();
+			void Clear();
+		private:
+			void MergeStoreBuffer(size_t first_byte);
+
+			std::vector<uint8_t> FontDataBytes;
+			std::vector<uint8_t> VariableTable;
+			std::vector<uint8_t> LastCharacter; // Packed on its own, kept by Release().
+			size_t character_bits;
+			size_t released_bytes;
+			uint32_t released_count;
+			uint32_t count;
+			uint8_t last_width;
+			uint8_t palette_format;
+			bool variable;
+	};
+
+	// In-memory representation handed from the Parser to the Emitter.
+	struct FontData
+	{
+		FontSettings Settings;
+		GlyphArena FontCharacterTable;
+	};
+}
+
+#endif
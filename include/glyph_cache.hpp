@@ -0,0 +1,58 @@
+#ifndef _GLYPH_CACHE_HPP_
+#define _GLYPH_CACHE_HPP_
+
+#include "types.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	struct GlyphKey
+	{
+		uint64_t low;
+		uint64_t high;
+
+		bool operator==(const GlyphKey &Other) const = default;
+	};
+
+	struct GlyphKeyHash
+	{
+		size_t operator()(const GlyphKey &Key) const
+		{
+			return static_cast<size_t>(Key.low);
+		}
+	};
+
+	// 128-bit hash of a character's rows together with everything else its packed bytes depend on.
+	GlyphKey HashCharacter(const std::string_view *lines, size_t line_count, const FontSettings &Settings, DrawMode draw_mode, uint16_t width);
+
+	// Packed characters from the previous assembly of a source, keyed by HashCharacter().  The file is
+	// replaced atomically on Save(), and a missing, truncated or foreign file just loads as empty, so it
+	// can be deleted at any time.  Find() may be called concurrently, but must be done before Keep()
+	// moves entries out; everything else is serial.  Only the entries passed to Keep() or Insert() since
+	// Load() are saved, so stale characters drop out.
+	class GlyphCache
+	{
+		public:
+			GlyphCache();
+			void Load(const std::string &path);
+			bool Save(const std::string &path);
+			void Advance();
+			const std::vector<uint8_t> *Find(const GlyphKey &Key) const;
+			void Keep(const GlyphKey &Key);
+			void Insert(const GlyphKey &Key, std::vector<uint8_t> &&Packed);
+			size_t GetHitCount() const;
+			size_t GetMissCount() const;
+		private:
+			std::unordered_map<GlyphKey, std::vector<uint8_t>, GlyphKeyHash> Entries;
+			std::unordered_map<GlyphKey, std::vector<uint8_t>, GlyphKeyHash> UsedEntries;
+			size_t loaded_count;
+			size_t hit_count;
+			size_t miss_count;
+	};
+}
+
+#endif
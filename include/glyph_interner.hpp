@@ -0,0 +1,30 @@
+#ifndef _GLYPH_INTERNER_HPP_
+#define _GLYPH_INTERNER_HPP_
+
+#include "types.hpp"
+#include "glyph_arena.hpp"
+#include "glyph_cache.hpp"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Interns the characters of an assembled font: every character is mapped to the first one with the
+	// same packed bytes and width, found by hash and then compared byte for byte with those of that hash.
+	// The arena has to hold the whole font, so this cannot be used after streaming.
+	class GlyphInterner
+	{
+		public:
+			GlyphInterner();
+			void Intern(const FontData &Font);
+			uint32_t GetFirstIndex(uint32_t index) const;
+			size_t GetUniqueCount() const;
+			std::vector<std::vector<uint32_t>> GetDuplicateGroups() const;
+		private:
+			std::unordered_multimap<GlyphKey, uint32_t, GlyphKeyHash> FirstIndices; // A key holds more than one character only when hashes collide.
+			std::vector<uint32_t> CharacterFirstIndices;
+	};
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _INCLUDE_CACHE_HPP_
+#define _INCLUDE_CACHE_HPP_
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// The characters an included source drew, along with the state it left behind.
+	struct IncludedBlock
+	{
+		std::vector<uint8_t> Packed; // Each character packed on its own, starting at bit 0.
+		std::vector<uint8_t> Widths; // Variable table bytes (width - 1), empty with Monospace spacing.
+		uint32_t count;
+		uint64_t file_size;
+		int64_t file_time;
+		DrawMode draw_mode;
+		uint16_t current_font_width;
+	};
+
+	// Included sources already parsed by this process, so an include shared by the fonts of a batch is
+	// only parsed once.  Blocks are keyed by the included file together with the palette format, maximum
+	// font size, spacing type, draw mode and current font width it was parsed with, and are only returned
+	// while the file's size and modification time are unchanged.  Safe to use from any number of threads.
+	class IncludeCache
+	{
+		public:
+			IncludeCache();
+			std::shared_ptr<const IncludedBlock> Find(const std::string &key, uint64_t file_size, int64_t file_time) const;
+			void Insert(const std::string &key, std::shared_ptr<const IncludedBlock> Block);
+		private:
+			mutable std::mutex Lock;
+			std::unordered_map<std::string, std::shared_ptr<const IncludedBlock>> Blocks;
+	};
+}
+
+#endif
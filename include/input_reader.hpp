@@ -0,0 +1,49 @@
+#ifndef _INPUT_READER_HPP_
+#define _INPUT_READER_HPP_
+
+#include "mapped_file.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Iterates the lines of an input source without copying them.  Regular files are memory mapped,
+	// anything else (such as pipes) falls back to large buffered reads.  The path '-' opens standard
+	// input, which never has to be seekable.  OpenBuffer() reads a source already in memory, which the
+	// caller keeps alive, as if it were mapped.  Lines may be of any length; the trailing '\n' (and '\r'
+	// for CRLF sources) is stripped.  A returned line stays valid until the next call to NextLine(), or
+	// until Close() when IsMapped().
+	class InputReader
+	{
+		public:
+			InputReader();
+			~InputReader();
+			InputReader(const InputReader &) = delete;
+			InputReader &operator=(const InputReader &) = delete;
+			bool Open(const std::string &path);
+			void OpenBuffer(std::string_view data);
+			void Close();
+			bool NextLine(std::string_view &line);
+			bool Rewind();
+			bool IsMapped() const;
+		private:
+			bool Refill();
+
+			static constexpr size_t ReadSize = 1 << 20;
+			MappedFile File;
+			const char *mapped_data; // The mapped file, or the buffer given to OpenBuffer().
+			size_t mapped_size;
+			size_t position;
+			std::FILE *file;
+			std::vector<char> buffer;
+			size_t buffer_start;
+			size_t buffer_end;
+			bool end_of_file;
+			bool borrowed;
+	};
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef _KEYWORDS_HPP_
+#define _KEYWORDS_HPP_
+
+#include "types.hpp"
+#include <string_view>
+#include <array>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	template <typename T>
+	struct Keyword
+	{
+		std::string_view name; // Must be uppercase.
+		T value;
+	};
+
+	constexpr char ToUpper(char c)
+	{
+		return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+	}
+
+	// Case-insensitive keyword table backed by a perfect hash that is searched for at compile time.
+	// Lookups hash the length plus the first, middle and last characters, then do a single compare.
+	template <typename T, size_t N>
+	class KeywordTable
+	{
+		public:
+			constexpr KeywordTable(const std::array<Keyword<T>, N> &Keywords) : Keywords(Keywords), Slots {}, seed(0)
+			{
+				for (uint32_t s = 1; s < 1024 && !seed; ++s)
+				{
+					std::array<uint8_t, SlotCount> slots {};
+					bool collision = false;
+					for (size_t k = 0; k < N && !collision; ++k)
+					{
+						uint32_t slot = Hash(Keywords[k].name, s);
+						if (slots[slot])
+						{
+							collision = true;
+						}
+						slots[slot] = static_cast<uint8_t>(k + 1);
+					}
+					if (!collision)
+					{
+						seed = s;
+						Slots = slots;
+					}
+				}
+			}
+
+			constexpr bool Valid() const
+			{
+				return seed != 0;
+			}
+
+			constexpr const T *Find(std::string_view token) const
+			{
+				if (token.empty())
+				{
+					return nullptr;
+				}
+				uint8_t slot = Slots[Hash(token, seed)];
+				if (!slot)
+				{
+					return nullptr;
+				}
+				const Keyword<T> &keyword = Keywords[slot - 1];
+				if (keyword.name.size() != token.size())
+				{
+					return nullptr;
+				}
+				for (size_t c = 0; c < token.size(); ++c)
+				{
+					if (ToUpper(token[c]) != keyword.name[c])
+					{
+						return nullptr;
+					}
+				}
+				return &keyword.value;
+			}
+		private:
+			static constexpr size_t SlotCount = (N <= 4) ? 8 : ((N <= 8) ? 32 : 64);
+
+			static constexpr uint32_t Hash(std::string_view str, uint32_t seed)
+			{
+				uint32_t hash = static_cast<uint32_t>(str.size());
+				hash = (hash * seed) + static_cast<uint8_t>(ToUpper(str.front()));
+				hash = (hash * seed) + static_cast<uint8_t>(ToUpper(str[str.size() / 2]));
+				hash = (hash * seed) + static_cast<uint8_t>(ToUpper(str.back()));
+				return (hash ^ (hash >> 7)) % SlotCount;
+			}
+
+			std::array<Keyword<T>, N> Keywords;
+			std::array<uint8_t, SlotCount> Slots;
+			uint32_t seed;
+	};
+
+	inline constexpr KeywordTable<TokenType, 12> TokenList({{
+		{ "COPY_GLYPH", TokenType::CopyGlyph },
+		{ "CURRENT_FONT_WIDTH", TokenType::CurrentFontWidth },
+		{ "DRAW", TokenType::Draw },
+		{ "DRAW_MODE", TokenType::DrawMode },
+		{ "FONT_NAME", TokenType::FontName },
+		{ "IMPORT_SHEET", TokenType::ImportSheet },
+		{ "INCLUDE", TokenType::Include },
+		{ "LANGUAGE", TokenType::Language },
+		{ "MAX_FONT_SIZE", TokenType::MaxFontSize },
+		{ "PALETTE_FORMAT", TokenType::PaletteFormat },
+		{ "REPEAT_GLYPH", TokenType::RepeatGlyph },
+		{ "SPACING_TYPE", TokenType::SpacingType }
+	}});
+
+	inline constexpr KeywordTable<DrawMode, 4> DrawModeList({{
+		{ "BINARY", DrawMode::Binary },
+		{ "OCTAL", DrawMode::Octal },
+		{ "DECIMAL", DrawMode::Decimal },
+		{ "HEXADECIMAL", DrawMode::Hexadecimal }
+	}});
+
+	inline constexpr KeywordTable<SpacingType, 2> SpacingTypeList({{
+		{ "MONOSPACE", SpacingType::Monospace },
+		{ "VARIABLE", SpacingType::Variable }
+	}});
+
+	inline constexpr KeywordTable<bool, 2> ToggleList({{
+		{ "OFF", false },
+		{ "ON", true }
+	}});
+
+	static_assert(TokenList.Valid() && DrawModeList.Valid() && SpacingTypeList.Valid() && ToggleList.Valid(), "No perfect hash seed was found for a keyword table.");
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef _LEXER_HPP_
+#define _LEXER_HPP_
+
+#include <string_view>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum class LexemeType
+	{
+		Word,
+		String,
+		UnterminatedString
+	};
+
+	struct Lexeme
+	{
+		LexemeType type;
+		std::string_view text; // Strings exclude their quotes.
+		size_t column;
+	};
+
+	// Splits a single source line into words and quoted strings, stopping at a ';' comment.
+	class Lexer
+	{
+		public:
+			Lexer();
+			void Reset(std::string_view line);
+			bool Next(Lexeme &lexeme);
+		private:
+			std::string_view line;
+			size_t position;
+	};
+}
+
+#endif
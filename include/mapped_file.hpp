@@ -0,0 +1,33 @@
+#ifndef _MAPPED_FILE_HPP_
+#define _MAPPED_FILE_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// A whole file held read-only in memory: memory mapped where possible, and read whole otherwise.
+	// Map() only maps, leaving the descriptor open and to the caller, for readers with their own
+	// fallback.  An empty regular file is held with a size of 0 and a valid data pointer.
+	class MappedFile
+	{
+		public:
+			MappedFile();
+			~MappedFile();
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+			bool Open(const std::string &path);
+			bool Map(int file_descriptor);
+			void Close();
+			const uint8_t *GetData() const;
+			size_t GetSize() const;
+		private:
+			const uint8_t *data;
+			size_t size;
+			bool mapped;
+			std::vector<uint8_t> FileData;
+	};
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef _NUMBER_PARSER_HPP_
+#define _NUMBER_PARSER_HPP_
+
+#include <string_view>
+#include <limits>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum NumberFormat : uint8_t
+	{
+		Decimal = 0x00,
+		Hexadecimal = 0x01,
+		Binary = 0x02
+	};
+
+	// Parses an entire operand as an unsigned integer literal (decimal, '0x' hexadecimal or '0b' binary).
+	// Mirrors std::from_chars, but rejects any trailing characters and values that do not fit in T.
+	// Never allocates, so it is safe to call for every directive.
+	template <typename T>
+	constexpr bool ParseNumber(std::string_view str, uint8_t formats, T &value)
+	{
+		uint8_t base = 10;
+		size_t max_digits = 0;
+		if (str.size() > 2 && str[0] == '0')
+		{
+			if ((formats & NumberFormat::Hexadecimal) && (str[1] == 'x' || str[1] == 'X'))
+			{
+				base = 16;
+				str.remove_prefix(2);
+			}
+			else if ((formats & NumberFormat::Binary) && (str[1] == 'b' || str[1] == 'B'))
+			{
+				base = 2;
+				max_digits = std::numeric_limits<T>::digits;
+				str.remove_prefix(2);
+			}
+		}
+		if (str.empty() || (max_digits && str.size() > max_digits))
+		{
+			return false;
+		}
+		uint64_t result = 0;
+		for (char c : str)
+		{
+			uint8_t digit = 0;
+			if (c >= '0' && c <= '9')
+			{
+				digit = static_cast<uint8_t>(c - '0');
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				digit = static_cast<uint8_t>(c - 'a' + 0xA);
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				digit = static_cast<uint8_t>(c - 'A' + 0xA);
+			}
+			else
+			{
+				return false;
+			}
+			if (digit >= base)
+			{
+				return false;
+			}
+			result = (result * base) + digit;
+			if (result > std::numeric_limits<T>::max())
+			{
+				return false;
+			}
+		}
+		value = static_cast<T>(result);
+		return true;
+	}
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef _PARSER_HPP_
+#define _PARSER_HPP_
+
+#include "types.hpp"
+#include "glyph_arena.hpp"
+#include "lexer.hpp"
+#include "row_decoder.hpp"
+#include "diagnostics.hpp"
+#include "input_reader.hpp"
+#include "statistics.hpp"
+#include "glyph_cache.hpp"
+#include "include_cache.hpp"
+#include "sheet_reader.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <filesystem>
+#include <limits>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	class StreamEmitter;
+
+	// A character whose rows were set aside by the serial pass, along with the state needed to decode it.
+	struct DeferredCharacter
+	{
+		static constexpr uint32_t NoIndex = std::numeric_limits<uint32_t>::max(); // Drawing was never turned off.
+
+		size_t first_line; // Index into the deferred lines.
+		size_t line_count;
+		size_t first_line_number;
+		uint32_t index;
+		uint16_t width;
+		DrawMode draw_mode;
+	};
+
+	// Copies of a character made while deferring, which can only be stored once it has been decoded.
+	struct DeferredCopy
+	{
+		uint32_t source;
+		uint32_t first_index;
+		uint32_t count;
+	};
+
+	// Consumes the Lexer's token stream line by line, tracks assembler state and builds the FontData IR.
+	// With deferred decoding, the rows of each character are only collected (they must stay valid, as with
+	// a memory mapped InputReader) and DecodeDeferredCharacters() then decodes and packs them on a thread
+	// pool (failing to start its threads is an error).  It returns false if any character produced a
+	// diagnostic, since those can only be reported in the right order by parsing serially; that pass then
+	// only decodes those characters again, storing the others as they were decoded.  Given a GlyphCache,
+	// characters whose rows and state are unchanged are copied from it instead of being decoded.  Reset()
+	// readies a Parser for another source without giving up its memory.  An include directive parses
+	// another source in place, relative to the file that includes it; each file is only included once per
+	// source, and a file including itself is an error.  Given an IncludeCache, includes that only draw
+	// characters are replayed from it when they were parsed before with the same settings.  repeat_glyph
+	// and copy_glyph add characters by copying ones already packed, along with their width, and
+	// import_sheet adds the cells of a PBM or PGM image a row of cells at a time.
+	class Parser
+	{
+		public:
+			static constexpr uint32_t MaxRepeatCount = 0x10000; // Copies added by a single repeat_glyph.
+
+			Parser(Diagnostics &diagnostics, StreamEmitter *Stream = nullptr, Statistics *Stats = nullptr);
+			void Reset(Diagnostics &diagnostics, StreamEmitter *Stream = nullptr, Statistics *Stats = nullptr);
+			void Parse(InputReader &input);
+			void ParseLine(std::string_view line);
+			void Finish();
+			const FontData &GetFontData() const;
+			FontData TakeFontData();
+			void SetDeferredDecoding(bool deferred);
+			bool DecodeDeferredCharacters(size_t thread_count, GlyphCache *Cache = nullptr);
+			bool IsCacheUpdated() const;
+			void SetSourcePath(std::string_view path);
+			void SetIncludeCache(IncludeCache *Includes);
+			void SetFileAccess(bool file_access);
+		private:
+			std::filesystem::path ResolvePath(const std::string &path) const;
+			void ParseInclude(size_t column);
+			void ParseSheetOperand(const Lexeme &lexeme);
+			void ImportSheet(size_t column);
+			void ReplayInclude(const IncludedBlock &Block);
+			void CopyCharacter(size_t column, uint32_t index, uint32_t copies);
+			bool IsDrawLine(std::string_view line);
+			bool DecodeDeferredCharacter(const FontSettings &Settings, const DeferredCharacter &Character, const std::string_view *lines);
+			bool DecodePixelRow(std::string_view line);
+			void ParseCommand(const Lexeme &lexeme);
+			void ParseOperand(const Lexeme &lexeme);
+			void ParseDrawToken(const Lexeme &lexeme);
+			bool IsPixelWord(std::string_view word) const;
+			void DrawPixelWord(const Lexeme &lexeme);
+			uint8_t DecodePixel(std::string_view digits, size_t column);
+			void DrawPixel(uint8_t pixel, size_t column);
+			uint16_t GetCharacterFontWidth() const;
+			void BeginCharacter();
+			void EndCharacter(size_t column);
+			void Warning(size_t column, WarningType warning_type);
+			void Error(size_t column, ErrorType error_type, std::string_view token = "");
+
+			Diagnostics *SourceDiagnostics;
+			StreamEmitter *Stream;
+			Statistics *Stats;
+			Lexer LineLexer;
+			RowDecoder PixelRowDecoder;
+			FontData Font;
+			FontCharacterData CurrentFontCharacter;
+			size_t current_line_number;
+			TokenType token_type;
+			size_t keyword_column;
+			bool operand_seen;
+			size_t operand_count;
+			bool line_error;
+			bool row_drawn;
+			DrawMode current_draw_mode;
+			DrawCoordinates current_draw_coordinates;
+			uint16_t current_font_width;
+			bool draw;
+			bool deferred;
+			std::vector<DeferredCharacter> DeferredCharacters;
+			std::vector<std::string_view> DeferredLines;
+			std::vector<DeferredCopy> DeferredCopies;
+			std::vector<uint8_t> CopiedCharacter;
+			GlyphArena DecodedCharacters; // Characters from a deferred pass that had diagnostics, by index.
+			std::vector<bool> Decoded; // Which of them were decoded without any.
+			bool reused_character;
+			bool cache_updated;
+			SheetReader Sheet;
+			std::vector<uint8_t> SheetCells; // A row of cells, each laid out as a character.
+			std::string pending_sheet;
+			size_t pending_sheet_column;
+			uint32_t sheet_columns;
+			uint32_t sheet_rows;
+			IncludeCache *Includes;
+			std::vector<std::string> IncludeStack; // The source and the includes being parsed, innermost last.
+			std::vector<std::string> IncludeNames; // As they were written, for diagnostics.
+			std::unordered_set<std::string> IncludedFiles;
+			std::vector<std::unique_ptr<InputReader>> IncludedSources; // Kept open while deferred lines point into them.
+			std::string pending_include;
+			size_t pending_include_column;
+			size_t setting_directive_count;
+			bool unmapped_include;
+			bool file_access;
+	};
+}
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef _PIXEL_FORMAT_HPP_
+#define _PIXEL_FORMAT_HPP_
+
+#include "types.hpp"
+#include <string_view>
+#include <array>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Number of digits that make up a single pixel, indexed by palette format - 1.
+	inline constexpr std::array<uint8_t, 8> OctalPixelDigits = { 1, 1, 1, 2, 2, 2, 3, 3 };
+	inline constexpr std::array<uint8_t, 8> DecimalPixelDigits = { 1, 1, 1, 2, 2, 2, 3, 3 };
+	inline constexpr std::array<uint8_t, 8> HexadecimalPixelDigits = { 1, 1, 1, 1, 2, 2, 2, 2 };
+
+	constexpr uint8_t GetPixelDigits(DrawMode draw_mode, uint8_t palette_format)
+	{
+		switch (draw_mode)
+		{
+			case DrawMode::Binary:
+			{
+				return palette_format;
+			}
+			case DrawMode::Octal:
+			{
+				return OctalPixelDigits[palette_format - 1];
+			}
+			case DrawMode::Decimal:
+			{
+				return DecimalPixelDigits[palette_format - 1];
+			}
+			case DrawMode::Hexadecimal:
+			{
+				return HexadecimalPixelDigits[palette_format - 1];
+			}
+		}
+		return 1;
+	}
+
+	constexpr uint8_t GetBase(DrawMode draw_mode)
+	{
+		switch (draw_mode)
+		{
+			case DrawMode::Binary:
+			{
+				return 2;
+			}
+			case DrawMode::Octal:
+			{
+				return 8;
+			}
+			case DrawMode::Decimal:
+			{
+				return 10;
+			}
+			case DrawMode::Hexadecimal:
+			{
+				return 16;
+			}
+		}
+		return 2;
+	}
+
+	constexpr std::string_view GetDrawModeName(DrawMode draw_mode)
+	{
+		switch (draw_mode)
+		{
+			case DrawMode::Binary:
+			{
+				return "binary";
+			}
+			case DrawMode::Octal:
+			{
+				return "octal";
+			}
+			case DrawMode::Decimal:
+			{
+				return "decimal";
+			}
+			case DrawMode::Hexadecimal:
+			{
+				return "hexadecimal";
+			}
+		}
+		return "";
+	}
+
+	constexpr std::string_view GetDigitRange(DrawMode draw_mode)
+	{
+		switch (draw_mode)
+		{
+			case DrawMode::Binary:
+			{
+				return "0s or 1s";
+			}
+			case DrawMode::Octal:
+			{
+				return "0-7s";
+			}
+			case DrawMode::Decimal:
+			{
+				return "0-9s";
+			}
+			case DrawMode::Hexadecimal:
+			{
+				return "0-Fs";
+			}
+		}
+		return "";
+	}
+
+	inline constexpr uint8_t SeparatorDigit = 0xFF;
+	inline constexpr uint8_t InvalidDigit = 0xFE;
+
+	// The value of every character that is a digit in the given draw mode (case insensitive), SeparatorDigit
+	// for spaces and tabs and InvalidDigit for anything else.
+	template <DrawMode Mode>
+	inline constexpr std::array<uint8_t, 256> DigitTable = []()
+	{
+		std::array<uint8_t, 256> Table {};
+		for (size_t c = 0; c < Table.size(); ++c)
+		{
+			uint8_t value = InvalidDigit;
+			if (c >= '0' && c <= '9')
+			{
+				value = static_cast<uint8_t>(c - '0');
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				value = static_cast<uint8_t>(c - 'A' + 0xA);
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				value = static_cast<uint8_t>(c - 'a' + 0xA);
+			}
+			Table[c] = (value < GetBase(Mode)) ? value : InvalidDigit;
+			if (c == ' ' || c == '\t')
+			{
+				Table[c] = SeparatorDigit;
+			}
+		}
+		return Table;
+	}();
+
+	constexpr const std::array<uint8_t, 256> &GetDigitTable(DrawMode draw_mode)
+	{
+		switch (draw_mode)
+		{
+			case DrawMode::Binary:
+			{
+				return DigitTable<DrawMode::Binary>;
+			}
+			case DrawMode::Octal:
+			{
+				return DigitTable<DrawMode::Octal>;
+			}
+			case DrawMode::Decimal:
+			{
+				return DigitTable<DrawMode::Decimal>;
+			}
+			case DrawMode::Hexadecimal:
+			{
+				return DigitTable<DrawMode::Hexadecimal>;
+			}
+		}
+		return DigitTable<DrawMode::Binary>;
+	}
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _ROW_DECODER_HPP_
+#define _ROW_DECODER_HPP_
+
+#include "types.hpp"
+#include <string_view>
+#include <vector>
+#include <array>
+#include <utility>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Fast path for draw lines that consist solely of whitespace separated pixel digits, such as
+	// "0001100011110000" or "3F 3F 00 12".  Classification and digit conversion run 16 (SSE2) or
+	// 32 (AVX2) characters at a time.  Decode() rejects anything that would need a diagnostic or the
+	// Parser's general tokenizer (comments, keywords, invalid digits, partial pixels, values beyond the
+	// palette format or rows wider than the character), leaving such lines to the scalar path.  There
+	// is a decoder for every draw mode and palette format, with the base, digits per pixel and maximum
+	// value as constants; Configure() picks one when drawing starts.
+	class RowDecoder
+	{
+		public:
+			RowDecoder();
+			void Configure(DrawMode draw_mode, uint8_t palette_format);
+			bool Decode(std::string_view line, uint8_t *pixels, size_t max_pixels, size_t &pixel_count);
+		private:
+			using DecodeFunction = bool (RowDecoder::*)(std::string_view line, uint8_t *pixels, size_t max_pixels, size_t &pixel_count);
+
+			template <DrawMode Mode, size_t... Formats>
+			static constexpr std::array<DecodeFunction, 8> GetDecoders(std::index_sequence<Formats...>);
+			template <DrawMode Mode, uint8_t Bits>
+			bool DecodeRow(std::string_view line, uint8_t *pixels, size_t max_pixels, size_t &pixel_count);
+			template <DrawMode Mode>
+			bool ConvertDigits(std::string_view line, size_t &separator_count);
+			template <uint8_t PixelDigits>
+			bool CompactDigits(size_t &digit_count);
+			template <DrawMode Mode, uint8_t Bits>
+			bool CombineDigits(size_t digit_count, uint8_t *pixels);
+
+			std::vector<uint8_t> Digits;
+			DecodeFunction Decoder;
+	};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _SHEET_READER_HPP_
+#define _SHEET_READER_HPP_
+
+#include "mapped_file.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	enum class SheetReadResult
+	{
+		Success,
+		OpenFailed,
+		InvalidHeader,
+		Truncated
+	};
+
+	// Reads a binary PBM (P4) or PGM (P5) image in place, memory mapped where possible (and read whole
+	// otherwise).  Rows are quantized to a palette format through a table built by SetPaletteFormat(),
+	// with ink being dark in both formats: PBM's black pixels become the palette's highest value, and
+	// PGM's gray values are scaled so black (0) is the highest value and the image's maximum value is 0.
+	class SheetReader
+	{
+		public:
+			SheetReader();
+			~SheetReader();
+			SheetReader(const SheetReader &) = delete;
+			SheetReader &operator=(const SheetReader &) = delete;
+			SheetReadResult Open(const std::string &path);
+			void Close();
+			uint32_t GetWidth() const;
+			uint32_t GetHeight() const;
+			void SetPaletteFormat(uint8_t palette_format);
+			void ReadRow(uint32_t y, uint32_t x, uint32_t count, uint8_t *pixels) const;
+		private:
+			MappedFile File;
+			std::vector<uint8_t> Levels; // Indexed by sample value.
+			const uint8_t *raster;
+			size_t row_size;
+			uint32_t width;
+			uint32_t height;
+			uint32_t max_value;
+			bool bitmap;
+	};
+}
+
+#endif
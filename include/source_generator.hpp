@@ -0,0 +1,42 @@
+#ifndef _SOURCE_GENERATOR_HPP_
+#define _SOURCE_GENERATOR_HPP_
+
+#include "types.hpp"
+#include <string>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	struct SourceConfig
+	{
+		uint8_t palette_format;
+		DrawMode draw_mode;
+		SpacingType spacing_type;
+		FontSizeData max_font_size;
+	};
+
+	struct GeneratedSource
+	{
+		std::string text;
+		size_t line_count;
+		size_t character_count;
+		size_t pixel_count;
+	};
+
+	// Produces synthetic assembler sources with random pixels.  The same seed and configuration always
+	// produce the same source.  Every 8th row ends with a comment and every 4th separates its pixels
+	// with spaces, so both the fast row decoder and the general tokenizer are exercised.
+	class SourceGenerator
+	{
+		public:
+			SourceGenerator(uint64_t seed);
+			void Generate(const SourceConfig &Config, size_t target_size, GeneratedSource &Source);
+		private:
+			uint64_t Next();
+			void AppendPixel(std::string &text, uint8_t pixel, uint8_t base, uint8_t pixel_digits);
+
+			uint64_t state;
+	};
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _SOURCE_WRITER_HPP_
+#define _SOURCE_WRITER_HPP_
+
+#include "types.hpp"
+#include "font_reader.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <cstdio>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Writes a MisbitFont back out as assembler source in a given draw mode, one character per draw
+	// block with every row written in full, so that assembling it reproduces the file.  Characters that
+	// the assembler could not produce (pixels beyond their width, or a width above the maximum font
+	// width) are written as closely as possible and counted as inexact, as are names with quotes or
+	// line breaks in them.
+	class SourceWriter
+	{
+		public:
+			SourceWriter(DrawMode draw_mode);
+			~SourceWriter();
+			SourceWriter(const SourceWriter &) = delete;
+			SourceWriter &operator=(const SourceWriter &) = delete;
+			bool Write(const FontReader &Font, const std::string &path, std::string_view comment);
+			size_t GetInexactCount() const;
+		private:
+			void WriteCharacter(const FontReader &Font, uint32_t index);
+			void WriteString(std::string_view directive, std::string_view text);
+			void Append(std::string_view text);
+			void Flush();
+
+			static constexpr size_t BufferSize = 1 << 20;
+			std::FILE *file;
+			std::vector<char> Buffer;
+			size_t buffer_size;
+			std::vector<uint8_t> Pixels;
+			std::array<std::array<char, 8>, 256> PixelText;
+			DrawMode draw_mode;
+			uint8_t pixel_digits;
+			uint16_t current_font_width;
+			size_t inexact_count;
+			bool good;
+	};
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef _STATISTICS_HPP_
+#define _STATISTICS_HPP_
+
+#include <array>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	class Diagnostics;
+
+	enum class Phase : uint8_t
+	{
+		Other, Read, Tokenize, Decode, Pack, Header, Write
+	};
+
+	enum class Counter : uint8_t
+	{
+		Lines, Directives, Characters, Pixels, BytesWritten, WorkerAllocations
+	};
+
+	// Collects the --stats report.  Time is attributed to exactly one phase at a time: entering a phase
+	// charges the time since the last switch to the phase being left.  Ticks come from the TSC where
+	// available, so timing every line stays cheap.  Restore() undoes the counting done since Save(), for
+	// work that is thrown away and redone; its time is moved to Other rather than charged twice.
+	class Statistics
+	{
+		public:
+			Statistics();
+			Phase Enter(Phase phase);
+			void Count(Counter counter, uint64_t amount = 1);
+			void Save();
+			void Restore();
+			void Report(Diagnostics &JobDiagnostics, uint64_t allocation_count);
+		private:
+			std::array<uint64_t, 7> PhaseTicks;
+			std::array<uint64_t, 6> Counters;
+			std::array<uint64_t, 7> SavedPhaseTicks;
+			std::array<uint64_t, 6> SavedCounters;
+			uint64_t start_ticks;
+			uint64_t last_ticks;
+			int64_t start_time;
+			Phase current_phase;
+	};
+
+	// Enters a phase for the lifetime of the scope, then returns to the previous one.  Does nothing without Statistics.
+	class PhaseScope
+	{
+		public:
+			PhaseScope(Statistics *Stats, Phase phase) : Stats(Stats), previous_phase(Stats ? Stats->Enter(phase) : Phase::Other)
+			{
+			}
+
+			~PhaseScope()
+			{
+				if (Stats)
+				{
+					Stats->Enter(previous_phase);
+				}
+			}
+		private:
+			Statistics *Stats;
+			Phase previous_phase;
+	};
+}
+
+#endif
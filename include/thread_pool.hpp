@@ -0,0 +1,55 @@
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	// Fixed-size work-stealing pool.  Each worker runs tasks from the back of its own queue and steals
+	// from the front of the other queues when it runs dry.  It never starts more threads than it is
+	// given tasks for or MaxThreadCount.  If a thread cannot be started, HasStarted() is false and no
+	// tasks may be submitted.
+	class ThreadPool
+	{
+		public:
+			static constexpr size_t MaxThreadCount = 256;
+
+			ThreadPool(size_t thread_count, size_t task_count = MaxThreadCount);
+			~ThreadPool();
+			ThreadPool(const ThreadPool &) = delete;
+			ThreadPool &operator=(const ThreadPool &) = delete;
+			void Submit(std::function<void()> &&Task);
+			void Wait();
+			size_t GetThreadCount() const;
+			bool HasStarted() const;
+		private:
+			struct WorkerQueue
+			{
+				std::mutex Lock;
+				std::deque<std::function<void()>> Tasks;
+			};
+
+			void WorkerLoop(size_t index);
+			bool TryTake(size_t index, std::function<void()> &Task);
+
+			std::vector<std::unique_ptr<WorkerQueue>> Queues;
+			std::vector<std::thread> Workers;
+			std::mutex StateLock;
+			std::condition_variable WorkAvailable;
+			std::condition_variable WorkDone;
+			size_t queued_count;
+			size_t pending_count;
+			size_t next_queue;
+			bool stopping;
+			bool start_failed;
+	};
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _TYPES_HPP_
+#define _TYPES_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace MisbitFontAssembler
+{
+	struct FontSizeData
+	{
+		uint16_t width;
+		uint16_t height;
+	};
+
+	struct DrawCoordinates
+	{
+		uint16_t x;
+		uint16_t y;
+	};
+
+	struct FontCharacterData
+	{
+		std::vector<uint8_t> character; // Decoded pixels (one per byte), max font width by max font height.  Reused for every character.
+		uint16_t width; // Used only with Variable Spacing.
+	};
+
+	enum class TokenType
+	{
+		None, CopyGlyph, CurrentFontWidth, Draw, DrawMode, FontName, ImportSheet, Include, Language,
+		MaxFontSize, PaletteFormat, RepeatGlyph, SpacingType
+	};
+
+	enum class ErrorType
+	{
+		NoError, InvalidToken, MissingOperand, InvalidValue, IllegalToken, UnsupportedPaletteFormat,
+		UnsupportedMaxFontSize, StringRequirement, UnterminatedString, IncludeFailed, IncludeCycle,
+		UndrawnCharacter, StreamedCharacter, FileAccessDisabled, ImportFailed, InvalidSheet, TruncatedSheet, SheetTooSmall, TooManyCharacters,
+		NotBdf, BdfOutOfPlace, BdfMissingBoundingBox, ThreadStartFailed
+	};
+
+	enum class WarningType
+	{
+		UnfinishedCharacter, FontNameTruncated, LanguageTruncated, CurrentFontWidthTooLarge,
+		CurrentFontWidthMonospace, DrawingAlreadyOn, DrawingAlreadyOff, MaxFontSizeLocked,
+		PaletteFormatLocked, SpacingTypeLocked, UnsupportedPixelValue, TruncatedPixelValue, OutOfBoundsY,
+		OutOfBoundsX, Count
+	};
+
+	enum class DrawMode
+	{
+		Binary,
+		Octal,
+		Decimal,
+		Hexadecimal
+	};
+
+	enum class SpacingType
+	{
+		Monospace,
+		Variable
+	};
+
+	struct FontSettings
+	{
+		uint8_t palette_format;
+		FontSizeData max_font_size;
+		SpacingType spacing_type;
+		std::string font_name;
+		std::string language;
+	};
+}
+
+#endif
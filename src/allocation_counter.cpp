@@ -0,0 +1,38 @@
+#include "../include/allocation_counter.hpp"
+#include <cstdlib>
+#include <new>
+
+void *operator new(std::size_t size)
+{
+	MisbitFontAssembler::CountThreadAllocation();
+	if (void *pointer = std::malloc(size ? size : 1))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
@@ -0,0 +1,85 @@
+#include "../include/assembler.hpp"
+
+MisbitFontAssembler::Assembler::Assembler() : SourceParser(AssemblyDiagnostics), cache_updated(false), imported(false)
+{
+}
+
+const MisbitFontAssembler::AssemblyResult &MisbitFontAssembler::Assembler::Assemble(std::string_view source, const AssemblerOptions &Options)
+{
+	AssemblyDiagnostics.Reset(Options.Reporting, Options.source_name);
+	SourceReader.OpenBuffer(source);
+	Result.success = Parse(SourceReader, AssemblyDiagnostics, Options);
+	SourceReader.Close();
+	Result.Bytes.clear();
+	Result.character_count = 0;
+	if (Result.success)
+	{
+		Emitter FontEmitter(Options.Stats);
+		FontEmitter.Write(GetFontData(), Result.Bytes);
+		Result.character_count = GetFontData().FontCharacterTable.GetCount();
+	}
+	Result.error_count = AssemblyDiagnostics.GetErrorCount();
+	Result.warning_count = AssemblyDiagnostics.GetWarningCount();
+	AssemblyDiagnostics.Summarize(Result.success);
+	Result.diagnostics = AssemblyDiagnostics.GetOutput();
+	return Result;
+}
+
+// Parses and decodes Input into the FontData, returning whether it assembled without errors.  With a
+// Stream, characters are written out as they are assembled instead.
+bool MisbitFontAssembler::Assembler::Parse(InputReader &Input, Diagnostics &SourceDiagnostics, const AssemblerOptions &Options, StreamEmitter *Stream)
+{
+	cache_updated = false;
+	imported = (Options.input_format == InputFormat::Bdf);
+	if (imported)
+	{
+		FontImporter.Import(Input, SourceDiagnostics, Stream, Options.Stats);
+		return SourceDiagnostics.GetErrorCount() == 0;
+	}
+	// The cache is only consulted when decoding characters on their own.
+	if ((Options.decode_thread_count != 1 || Options.Cache) && !Stream && Input.IsMapped())
+	{
+		size_t output_size = SourceDiagnostics.GetOutputSize();
+		if (Options.Stats)
+		{
+			Options.Stats->Save();
+		}
+		SourceParser.Reset(SourceDiagnostics, nullptr, Options.Stats);
+		SourceParser.SetSourcePath(Options.source_name);
+		SourceParser.SetIncludeCache(Options.Includes);
+		SourceParser.SetFileAccess(Options.file_access);
+		SourceParser.SetDeferredDecoding(true);
+		SourceParser.Parse(Input);
+		bool clean = SourceParser.DecodeDeferredCharacters(Options.decode_thread_count, Options.Cache);
+		cache_updated = SourceParser.IsCacheUpdated();
+		if (clean)
+		{
+			return SourceDiagnostics.GetErrorCount() == 0;
+		}
+		// Only the serial path reports diagnostics from inside characters in the right order, though it
+		// only decodes the characters that had them again.
+		SourceDiagnostics.Reset(output_size);
+		if (Options.Stats)
+		{
+			Options.Stats->Restore();
+		}
+		Input.Rewind();
+	}
+	SourceParser.Reset(SourceDiagnostics, Stream, Options.Stats);
+	SourceParser.SetSourcePath(Options.source_name);
+	SourceParser.SetIncludeCache(Options.Includes);
+	SourceParser.SetFileAccess(Options.file_access);
+	SourceParser.Parse(Input);
+	return SourceDiagnostics.GetErrorCount() == 0;
+}
+
+const MisbitFontAssembler::FontData &MisbitFontAssembler::Assembler::GetFontData() const
+{
+	return imported ? FontImporter.GetFontData() : SourceParser.GetFontData();
+}
+
+// Whether the last Parse() went through the cache, leaving it with the entries to save.
+bool MisbitFontAssembler::Assembler::IsCacheUpdated() const
+{
+	return cache_updated;
+}
@@ -0,0 +1,368 @@
+#include "../include/bdf_importer.hpp"
+#include "../include/number_parser.hpp"
+#include "../include/emitter.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	constexpr std::string_view Whitespace(" \t\r\v\f", 5);
+
+	// Splits off the next whitespace separated field, setting column to where it starts.
+	std::string_view NextField(std::string_view line, size_t &position, size_t &column)
+	{
+		size_t start = line.find_first_not_of(Whitespace, position);
+		if (start == std::string_view::npos)
+		{
+			position = line.size();
+			return {};
+		}
+		size_t end = std::min(line.find_first_of(Whitespace, start), line.size());
+		position = end;
+		column = start;
+		return line.substr(start, end - start);
+	}
+
+	bool ParseInteger(std::string_view text, int32_t &value)
+	{
+		bool negative = !text.empty() && text[0] == '-';
+		uint32_t magnitude = 0;
+		if (!ParseNumber(text.substr(negative ? 1 : 0), MisbitFontAssembler::NumberFormat::Decimal, magnitude) || magnitude > static_cast<uint32_t>(std::numeric_limits<int32_t>::max()))
+		{
+			return false;
+		}
+		value = negative ? -static_cast<int32_t>(magnitude) : static_cast<int32_t>(magnitude);
+		return true;
+	}
+
+	// The rest of the line after the keyword, without the quotes around a property's string value.
+	std::string_view GetStringValue(std::string_view line, size_t position)
+	{
+		size_t start = line.find_first_not_of(Whitespace, position);
+		if (start == std::string_view::npos)
+		{
+			return {};
+		}
+		std::string_view value = line.substr(start, line.find_last_not_of(Whitespace) + 1 - start);
+		if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+		{
+			value = value.substr(1, value.size() - 2);
+		}
+		return value;
+	}
+
+	uint8_t GetHexDigit(char c)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return static_cast<uint8_t>(c - '0');
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			return static_cast<uint8_t>(c - 'a' + 0xA);
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			return static_cast<uint8_t>(c - 'A' + 0xA);
+		}
+		return 0xFF;
+	}
+}
+
+MisbitFontAssembler::BdfImporter::BdfImporter() : ImportDiagnostics(nullptr), Stream(nullptr), Stats(nullptr), Font { { 1, { 1, 1 }, SpacingType::Monospace, "", "" }, {} }, current_line_number(1), box_x(0), box_y(0), glyph_width(0), glyph_height(0), glyph_x(0), glyph_y(0), device_width(0), default_device_width(0), bitmap_row(0), bounding_box_seen(false), font_started(false), font_ended(false), character_started(false), bitmap(false)
+{
+}
+
+void MisbitFontAssembler::BdfImporter::Import(InputReader &input, Diagnostics &diagnostics, StreamEmitter *Stream, Statistics *Stats)
+{
+	ImportDiagnostics = &diagnostics;
+	this->Stream = Stream;
+	this->Stats = Stats;
+	Font.Settings = { 1, { 1, 1 }, SpacingType::Monospace, "", "" };
+	Font.FontCharacterTable.Clear();
+	current_line_number = 1;
+	box_x = 0;
+	box_y = 0;
+	default_device_width = 0;
+	bounding_box_seen = false;
+	font_started = false;
+	font_ended = false;
+	character_started = false;
+	bitmap = false;
+	std::string_view line;
+	{
+		PhaseScope ReadScope(Stats, Phase::Read);
+		while (!font_ended && input.NextLine(line))
+		{
+			if (Stats)
+			{
+				Stats->Count(Counter::Lines);
+			}
+			ParseLine(line);
+			++current_line_number;
+		}
+	}
+	--current_line_number;
+	if (!font_started)
+	{
+		Error(0, ErrorType::NotBdf);
+	}
+	else if (!bounding_box_seen)
+	{
+		Error(0, ErrorType::BdfMissingBoundingBox);
+	}
+	else if (character_started)
+	{
+		Warning(0, WarningType::UnfinishedCharacter);
+	}
+}
+
+const MisbitFontAssembler::FontData &MisbitFontAssembler::BdfImporter::GetFontData() const
+{
+	return Font;
+}
+
+void MisbitFontAssembler::BdfImporter::ParseLine(std::string_view line)
+{
+	size_t position = 0;
+	size_t column = 0;
+	std::string_view keyword = NextField(line, position, column);
+	if (keyword.empty())
+	{
+		return;
+	}
+	if (bitmap && keyword != "ENDCHAR")
+	{
+		DecodeBitmapRow(line);
+		return;
+	}
+	// Anything else means this is not a BDF font, which Import() reports.
+	if (!font_started)
+	{
+		font_started = (keyword == "STARTFONT");
+		font_ended = !font_started;
+		return;
+	}
+	bool locked = character_started || Font.FontCharacterTable.GetCount() > 0;
+	if (keyword == "FONTBOUNDINGBOX")
+	{
+		if (locked)
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		int32_t width = 0;
+		int32_t height = 0;
+		size_t value_column = column;
+		std::string_view width_field = NextField(line, position, value_column);
+		std::string_view height_field = NextField(line, position, value_column);
+		std::string_view x_field = NextField(line, position, value_column);
+		std::string_view y_field = NextField(line, position, value_column);
+		if (!ParseInteger(width_field, width) || !ParseInteger(height_field, height) || !ParseInteger(x_field, box_x) || !ParseInteger(y_field, box_y))
+		{
+			Error(value_column, ErrorType::InvalidValue, line.substr(value_column));
+			return;
+		}
+		if (width < 1 || width > 256 || height < 1 || height > 256)
+		{
+			Error(column, ErrorType::UnsupportedMaxFontSize, keyword);
+			return;
+		}
+		Font.Settings.max_font_size = { static_cast<uint16_t>(width), static_cast<uint16_t>(height) };
+		default_device_width = width + box_x;
+		bounding_box_seen = true;
+	}
+	else if (keyword == "FONT" || keyword == "FAMILY_NAME")
+	{
+		// The family name is friendlier than the XLFD name, so it replaces it when the properties give one.
+		std::string_view font_name = GetStringValue(line, position);
+		if (keyword == "FAMILY_NAME" || Font.Settings.font_name.empty())
+		{
+			if (font_name.size() > 64)
+			{
+				Warning(column, WarningType::FontNameTruncated);
+			}
+			Font.Settings.font_name = font_name;
+		}
+	}
+	else if (keyword == "SPACING")
+	{
+		if (locked)
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		std::string_view spacing = GetStringValue(line, position);
+		Font.Settings.spacing_type = (spacing == "P" || spacing == "p") ? SpacingType::Variable : SpacingType::Monospace;
+	}
+	else if (keyword == "STARTCHAR")
+	{
+		if (character_started)
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		// Characters cannot be placed without a cell, which Import() reports.
+		if (!bounding_box_seen)
+		{
+			font_ended = true;
+			return;
+		}
+		const FontSizeData &max_font_size = Font.Settings.max_font_size;
+		if (Font.FontCharacterTable.GetCount() == 0)
+		{
+			Font.FontCharacterTable.Configure(Font.Settings);
+		}
+		Character.assign(static_cast<size_t>(max_font_size.width) * max_font_size.height, 0);
+		glyph_width = max_font_size.width;
+		glyph_height = max_font_size.height;
+		glyph_x = box_x;
+		glyph_y = box_y;
+		device_width = default_device_width;
+		character_started = true;
+	}
+	else if (keyword == "DWIDTH" || keyword == "BBX")
+	{
+		// A DWIDTH before the characters (METRICSSET 0 fonts) is the default for all of them.
+		if (!character_started && keyword == "BBX")
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		size_t value_column = column;
+		std::string_view first_field = NextField(line, position, value_column);
+		if (keyword == "DWIDTH")
+		{
+			if (!ParseInteger(first_field, character_started ? device_width : default_device_width))
+			{
+				Error(value_column, ErrorType::InvalidValue, first_field);
+			}
+			return;
+		}
+		std::string_view height_field = NextField(line, position, value_column);
+		std::string_view x_field = NextField(line, position, value_column);
+		std::string_view y_field = NextField(line, position, value_column);
+		if (!ParseInteger(first_field, glyph_width) || !ParseInteger(height_field, glyph_height) || !ParseInteger(x_field, glyph_x) || !ParseInteger(y_field, glyph_y) || glyph_width < 0 || glyph_height < 0)
+		{
+			Error(value_column, ErrorType::InvalidValue, line.substr(value_column));
+		}
+	}
+	else if (keyword == "BITMAP")
+	{
+		if (!character_started)
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		bitmap = true;
+		bitmap_row = 0;
+	}
+	else if (keyword == "ENDCHAR")
+	{
+		if (!character_started)
+		{
+			Error(column, ErrorType::BdfOutOfPlace, keyword);
+			return;
+		}
+		EndCharacter();
+	}
+	else if (keyword == "ENDFONT")
+	{
+		font_ended = true;
+	}
+}
+
+// Sets the pixels of one hexadecimal BITMAP row, placing the character's bounding box inside the font's.
+void MisbitFontAssembler::BdfImporter::DecodeBitmapRow(std::string_view line)
+{
+	PhaseScope DecodeScope(Stats, Phase::Decode);
+	size_t position = 0;
+	size_t column = 0;
+	std::string_view row = NextField(line, position, column);
+	if (row.size() % 2)
+	{
+		Error(column, ErrorType::InvalidValue, row);
+		return;
+	}
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	int32_t y = (max_font_size.height + box_y) - (glyph_y + glyph_height) + bitmap_row++;
+	int32_t left = glyph_x - box_x;
+	for (size_t i = 0; i < row.size(); i += 2)
+	{
+		uint8_t high = GetHexDigit(row[i]);
+		uint8_t low = GetHexDigit(row[i + 1]);
+		if (high > 0xF || low > 0xF)
+		{
+			Error(column, ErrorType::InvalidValue, row);
+			return;
+		}
+		uint8_t bits = static_cast<uint8_t>((high << 4) | low);
+		for (int32_t bit = 0; bits && bit < 8; ++bit, bits = static_cast<uint8_t>(bits << 1))
+		{
+			int32_t x = static_cast<int32_t>(i * 4) + bit;
+			if (!(bits & 0x80) || x >= glyph_width)
+			{
+				continue;
+			}
+			// Only set pixels falling outside the cell are lost.
+			if (y < 0 || y >= max_font_size.height || bitmap_row > glyph_height)
+			{
+				Warning(column + i, WarningType::OutOfBoundsY);
+			}
+			else if (left + x < 0 || left + x >= max_font_size.width)
+			{
+				Warning(column + i, WarningType::OutOfBoundsX);
+			}
+			else
+			{
+				Character[(static_cast<size_t>(y) * max_font_size.width) + left + x] = 1;
+			}
+		}
+	}
+}
+
+void MisbitFontAssembler::BdfImporter::EndCharacter()
+{
+	character_started = false;
+	bitmap = false;
+	// The width runs from the cell's left edge (the font's leftmost extent) to the next character's origin.
+	// Like drawn characters, pixels past it are not kept, which drops overhangs (as in italic fonts).
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	uint16_t width = 0;
+	if (Font.Settings.spacing_type == SpacingType::Variable)
+	{
+		width = static_cast<uint16_t>(std::clamp<int32_t>(device_width - box_x, 1, max_font_size.width));
+		for (size_t y = 0; y < max_font_size.height && width < max_font_size.width; ++y)
+		{
+			std::fill_n(&Character[(y * max_font_size.width) + width], max_font_size.width - width, 0);
+		}
+	}
+	if (!Font.FontCharacterTable.HasRoom(1))
+	{
+		Error(0, ErrorType::TooManyCharacters);
+		return;
+	}
+	{
+		PhaseScope PackScope(Stats, Phase::Pack);
+		Font.FontCharacterTable.Append(Character.data(), width);
+	}
+	if (Stats)
+	{
+		Stats->Count(Counter::Characters);
+		Stats->Count(Counter::Pixels, Character.size());
+	}
+	if (Stream)
+	{
+		Stream->WriteCharacters(Font);
+	}
+}
+
+void MisbitFontAssembler::BdfImporter::Warning(size_t column, WarningType warning_type)
+{
+	ImportDiagnostics->Warning(current_line_number, column, warning_type);
+}
+
+void MisbitFontAssembler::BdfImporter::Error(size_t column, ErrorType error_type, std::string_view token)
+{
+	ImportDiagnostics->Error(current_line_number, column, error_type, TokenType::None, token);
+}
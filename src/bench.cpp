@@ -0,0 +1,273 @@
+#include "../include/source_generator.hpp"
+#include "../include/input_reader.hpp"
+#include "../include/parser.hpp"
+#include "../include/emitter.hpp"
+#include "../include/diagnostics.hpp"
+#include "../include/keywords.hpp"
+#include "../include/number_parser.hpp"
+#include "../include/pixel_format.hpp"
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <fmt/core.h>
+#if __has_include(<sys/wait.h>)
+#define MISBITFONT_BENCH_USE_FORK
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using namespace MisbitFontAssembler;
+
+	struct BenchOptions
+	{
+		std::vector<uint8_t> PaletteFormats = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		std::vector<DrawMode> DrawModes = { DrawMode::Binary, DrawMode::Octal, DrawMode::Decimal, DrawMode::Hexadecimal };
+		std::vector<SpacingType> SpacingTypes = { SpacingType::Monospace, SpacingType::Variable };
+		std::vector<FontSizeData> FontSizes = { { 8, 8 }, { 16, 16 }, { 32, 32 }, { 64, 64 }, { 128, 128 }, { 256, 256 } };
+		size_t source_size = 1 << 20;
+		size_t repeat = 3;
+		std::string generate_directory;
+	};
+
+	struct BenchResult
+	{
+		double seconds;
+		long peak_rss; // In KiB, -1 when unknown.
+	};
+
+	void PrintFormat()
+	{
+		fmt::print("Format:  misbitfont_bench [options]\n");
+		fmt::print("         --palette-format [1-8]      Only benchmark this palette format.\n");
+		fmt::print("         --draw-mode [mode]          Only benchmark this draw mode.\n");
+		fmt::print("         --spacing-type [type]       Only benchmark this spacing type.\n");
+		fmt::print("         --max-font-size [WxH]       Only benchmark this character size.\n");
+		fmt::print("         --source-size [bytes]       Approximate size of each generated source (default 1048576).\n");
+		fmt::print("         --repeat [count]            Runs per configuration, the fastest is reported (default 3).\n");
+		fmt::print("         --generate [directory]      Write the generated sources instead of benchmarking.\n");
+	}
+
+	bool ParseFontSize(std::string_view value, FontSizeData &FontSize)
+	{
+		size_t separator = value.find_first_of("xX");
+		return separator != std::string_view::npos && ParseNumber(value.substr(0, separator), NumberFormat::Decimal, FontSize.width) && ParseNumber(value.substr(separator + 1), NumberFormat::Decimal, FontSize.height) && FontSize.width >= 1 && FontSize.width <= 256 && FontSize.height >= 1 && FontSize.height <= 256;
+	}
+
+	bool ParseArguments(int argc, char *argv[], BenchOptions &Options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string_view option = argv[i];
+			if (option == "--help" || i + 1 >= argc)
+			{
+				PrintFormat();
+				return false;
+			}
+			std::string_view value = argv[++i];
+			bool valid = true;
+			if (option == "--palette-format")
+			{
+				uint8_t palette_format = 0;
+				valid = ParseNumber(value, NumberFormat::Decimal, palette_format) && palette_format >= 1 && palette_format <= 8;
+				Options.PaletteFormats = { palette_format };
+			}
+			else if (option == "--draw-mode")
+			{
+				const DrawMode *Mode = DrawModeList.Find(value);
+				valid = (Mode != nullptr);
+				Options.DrawModes = { Mode ? *Mode : DrawMode::Binary };
+			}
+			else if (option == "--spacing-type")
+			{
+				const SpacingType *Spacing = SpacingTypeList.Find(value);
+				valid = (Spacing != nullptr);
+				Options.SpacingTypes = { Spacing ? *Spacing : SpacingType::Monospace };
+			}
+			else if (option == "--max-font-size")
+			{
+				FontSizeData FontSize = { 0, 0 };
+				valid = ParseFontSize(value, FontSize);
+				Options.FontSizes = { FontSize };
+			}
+			else if (option == "--source-size")
+			{
+				valid = ParseNumber(value, NumberFormat::Decimal, Options.source_size);
+			}
+			else if (option == "--repeat")
+			{
+				valid = ParseNumber(value, NumberFormat::Decimal, Options.repeat) && Options.repeat > 0;
+			}
+			else if (option == "--generate")
+			{
+				Options.generate_directory = value;
+			}
+			else
+			{
+				PrintFormat();
+				return false;
+			}
+			if (!valid)
+			{
+				fmt::print("Invalid value '{}' for '{}'.\n", value, option);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::string GetConfigName(const SourceConfig &Config)
+	{
+		return fmt::format("pf{}_{}_{}_{}x{}", Config.palette_format, GetDrawModeName(Config.draw_mode), (Config.spacing_type == SpacingType::Variable) ? "variable" : "monospace", Config.max_font_size.width, Config.max_font_size.height);
+	}
+
+	// Assembles the source the same way the assembler does, returning the fastest run in seconds or a negative value on failure.
+	double RunAssembly(const std::string &input_path, const std::string &output_path, size_t repeat)
+	{
+		double best = -1.0;
+		for (size_t r = 0; r < repeat; ++r)
+		{
+			auto start = std::chrono::steady_clock::now();
+			Diagnostics BenchDiagnostics;
+			InputReader input_file;
+			if (!input_file.Open(input_path))
+			{
+				return -1.0;
+			}
+			Parser SourceParser(BenchDiagnostics);
+			SourceParser.Parse(input_file);
+			Emitter FontEmitter;
+			if (BenchDiagnostics.GetErrorCount() != 0 || BenchDiagnostics.GetWarningCount() != 0 || !FontEmitter.Write(SourceParser.GetFontData(), output_path))
+			{
+				return -1.0;
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (best < 0.0 || seconds < best)
+			{
+				best = seconds;
+			}
+		}
+		return best;
+	}
+
+	// Each configuration runs in its own process so its peak RSS is not hidden by an earlier, larger one.
+	bool Benchmark(const std::string &input_path, const std::string &output_path, size_t repeat, BenchResult &Result)
+	{
+#ifdef MISBITFONT_BENCH_USE_FORK
+		int result_pipe[2];
+		if (pipe(result_pipe) != 0)
+		{
+			return false;
+		}
+		fflush(stdout);
+		pid_t child = fork();
+		if (child < 0)
+		{
+			close(result_pipe[0]);
+			close(result_pipe[1]);
+			return false;
+		}
+		if (child == 0)
+		{
+			close(result_pipe[0]);
+			double seconds = RunAssembly(input_path, output_path, repeat);
+			bool written = write(result_pipe[1], &seconds, sizeof(seconds)) == sizeof(seconds);
+			_exit((written && seconds >= 0.0) ? 0 : 1);
+		}
+		close(result_pipe[1]);
+		double seconds = -1.0;
+		bool received = read(result_pipe[0], &seconds, sizeof(seconds)) == sizeof(seconds);
+		close(result_pipe[0]);
+		int status = 0;
+		struct rusage usage;
+		if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received)
+		{
+			return false;
+		}
+		Result = { seconds, usage.ru_maxrss };
+		return true;
+#else
+		Result = { RunAssembly(input_path, output_path, repeat), -1 };
+		return Result.seconds >= 0.0;
+#endif
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	BenchOptions Options;
+	if (!ParseArguments(argc, argv, Options))
+	{
+		return -1;
+	}
+	bool generate_only = !Options.generate_directory.empty();
+	std::filesystem::path directory = generate_only ? std::filesystem::path(Options.generate_directory) : std::filesystem::temp_directory_path() / fmt::format("misbitfont_bench_{}", std::chrono::steady_clock::now().time_since_epoch().count());
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error)
+	{
+		fmt::print("Unable to create '{}'.\n", directory.string());
+		return -1;
+	}
+	std::string output_path = (directory / "bench.msbtfont").string();
+	if (!generate_only)
+	{
+		fmt::print("{:<32} {:>12} {:>14} {:>12} {:>10} {:>12}\n", "Configuration", "Lines/s", "Pixels/s", "Glyphs/s", "MB/s", "Peak RSS");
+	}
+	int retcode = 0;
+	GeneratedSource Source;
+	for (const FontSizeData &FontSize : Options.FontSizes)
+	{
+		for (SpacingType Spacing : Options.SpacingTypes)
+		{
+			for (DrawMode Mode : Options.DrawModes)
+			{
+				for (uint8_t palette_format : Options.PaletteFormats)
+				{
+					SourceConfig Config = { palette_format, Mode, Spacing, FontSize };
+					std::string name = GetConfigName(Config);
+					// Seeded per configuration so filtering the matrix does not change a configuration's source.
+					SourceGenerator Generator((static_cast<uint64_t>(FontSize.width) << 32) | (static_cast<uint64_t>(FontSize.height) << 16) | (static_cast<uint64_t>(Spacing) << 12) | (static_cast<uint64_t>(Mode) << 8) | palette_format);
+					Generator.Generate(Config, Options.source_size, Source);
+					std::string input_path = (directory / (name + ".txt")).string();
+					{
+						std::ofstream input_file(input_path, std::ios::binary);
+						input_file.write(Source.text.data(), Source.text.size());
+						if (!input_file.good())
+						{
+							fmt::print("Unable to write '{}'.\n", input_path);
+							return -1;
+						}
+					}
+					if (generate_only)
+					{
+						fmt::print("Generated {} ({} characters).\n", input_path, Source.character_count);
+						continue;
+					}
+					size_t source_size = Source.text.size();
+					// Released so the benchmark process does not inherit it.
+					std::string().swap(Source.text);
+					BenchResult Result;
+					if (!Benchmark(input_path, output_path, Options.repeat, Result))
+					{
+						fmt::print("{:<32} failed to assemble\n", name);
+						retcode = -1;
+					}
+					else
+					{
+						fmt::print("{:<32} {:>12.0f} {:>14.0f} {:>12.0f} {:>10.2f} {:>9} KiB\n", name, Source.line_count / Result.seconds, Source.pixel_count / Result.seconds, Source.character_count / Result.seconds, (source_size / 1048576.0) / Result.seconds, Result.peak_rss);
+					}
+					std::filesystem::remove(input_path, error);
+				}
+			}
+		}
+	}
+	if (!generate_only)
+	{
+		std::filesystem::remove_all(directory, error);
+	}
+	return retcode;
+}
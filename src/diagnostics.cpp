@@ -0,0 +1,491 @@
+#include "../include/diagnostics.hpp"
+#include "../include/pixel_format.hpp"
+#include <iterator>
+
+namespace
+{
+	std::string_view GetTokenName(MisbitFontAssembler::TokenType token_type)
+	{
+		using MisbitFontAssembler::TokenType;
+		switch (token_type)
+		{
+			case TokenType::CopyGlyph:
+			{
+				return "COPY_GLYPH";
+			}
+			case TokenType::CurrentFontWidth:
+			{
+				return "CURRENT_FONT_WIDTH";
+			}
+			case TokenType::Draw:
+			{
+				return "DRAW";
+			}
+			case TokenType::DrawMode:
+			{
+				return "DRAW_MODE";
+			}
+			case TokenType::FontName:
+			{
+				return "FONT_NAME";
+			}
+			case TokenType::ImportSheet:
+			{
+				return "IMPORT_SHEET";
+			}
+			case TokenType::Include:
+			{
+				return "INCLUDE";
+			}
+			case TokenType::Language:
+			{
+				return "LANGUAGE";
+			}
+			case TokenType::MaxFontSize:
+			{
+				return "MAX_FONT_SIZE";
+			}
+			case TokenType::PaletteFormat:
+			{
+				return "PALETTE_FORMAT";
+			}
+			case TokenType::RepeatGlyph:
+			{
+				return "REPEAT_GLYPH";
+			}
+			case TokenType::SpacingType:
+			{
+				return "SPACING_TYPE";
+			}
+			default:
+			{
+				return "";
+			}
+		}
+	}
+
+	struct WarningInfo
+	{
+		std::string_view kind;
+		std::string_view message;
+	};
+
+	// Indexed by WarningType.  {0} and {1} are replaced with the draw mode's digit range and name.
+	constexpr std::array<WarningInfo, static_cast<size_t>(MisbitFontAssembler::WarningType::Count)> WarningList = {{
+		{ "unfinished_character", "Drawing was not turned off before the end of the input.  The unfinished character was discarded." },
+		{ "font_name_truncated", "Font Name specified takes up more than 64 bytes.  Upon assembly, it will be truncated." },
+		{ "language_truncated", "Language specified takes up more than 64 bytes.  Upon assembly, it will be truncated." },
+		{ "current_font_width_too_large", "Current font width must not be greater than the max font width.  This statement has no effect." },
+		{ "current_font_width_monospace", "Setting the current font width is unsupported in 'monospace' mode.  No changes were made as a result." },
+		{ "drawing_already_on", "Drawing is already on.  This statement has no effect." },
+		{ "drawing_already_off", "Drawing is already off.  This statement has no effect." },
+		{ "max_font_size_locked", "You can only specify the max font size if nothing has been drawn.  This statement has no effect." },
+		{ "palette_format_locked", "You can only specify the palette format if nothing has been drawn.  This statement has no effect." },
+		{ "spacing_type_locked", "You can only specify the spacing type format if nothing has been drawn.  This statement has no effect." },
+		{ "unsupported_pixel_value", "Unsupported value (must be {0} in {1} drawing mode).  This pixel will be zeroed." },
+		{ "truncated_pixel_value", "Value is beyond the maximum limit for the palette format used while in {1} drawing mode.  This pixel will be truncated to fit." },
+		{ "out_of_bounds_y", "Drawing out of bounds on the y-axis.  Skipping pixel." },
+		{ "out_of_bounds_x", "Drawing out of bounds on the x-axis.  Skipping pixel." }
+	}};
+
+	std::string_view GetErrorKind(MisbitFontAssembler::ErrorType error_type)
+	{
+		using MisbitFontAssembler::ErrorType;
+		switch (error_type)
+		{
+			case ErrorType::InvalidToken:
+			{
+				return "invalid_token";
+			}
+			case ErrorType::MissingOperand:
+			{
+				return "missing_operand";
+			}
+			case ErrorType::InvalidValue:
+			{
+				return "invalid_value";
+			}
+			case ErrorType::IllegalToken:
+			{
+				return "illegal_token";
+			}
+			case ErrorType::UnsupportedPaletteFormat:
+			{
+				return "unsupported_palette_format";
+			}
+			case ErrorType::UnsupportedMaxFontSize:
+			{
+				return "unsupported_max_font_size";
+			}
+			case ErrorType::StringRequirement:
+			{
+				return "string_requirement";
+			}
+			case ErrorType::UnterminatedString:
+			{
+				return "unterminated_string";
+			}
+			case ErrorType::IncludeFailed:
+			{
+				return "include_failed";
+			}
+			case ErrorType::IncludeCycle:
+			{
+				return "include_cycle";
+			}
+			case ErrorType::UndrawnCharacter:
+			{
+				return "undrawn_character";
+			}
+			case ErrorType::StreamedCharacter:
+			{
+				return "streamed_character";
+			}
+			case ErrorType::FileAccessDisabled:
+			{
+				return "file_access_disabled";
+			}
+			case ErrorType::ImportFailed:
+			{
+				return "import_failed";
+			}
+			case ErrorType::InvalidSheet:
+			{
+				return "invalid_sheet";
+			}
+			case ErrorType::TruncatedSheet:
+			{
+				return "truncated_sheet";
+			}
+			case ErrorType::SheetTooSmall:
+			{
+				return "sheet_too_small";
+			}
+			case ErrorType::TooManyCharacters:
+			{
+				return "too_many_characters";
+			}
+			case ErrorType::NotBdf:
+			{
+				return "not_bdf";
+			}
+			case ErrorType::BdfOutOfPlace:
+			{
+				return "bdf_out_of_place";
+			}
+			case ErrorType::BdfMissingBoundingBox:
+			{
+				return "bdf_missing_bounding_box";
+			}
+			case ErrorType::ThreadStartFailed:
+			{
+				return "thread_start_failed";
+			}
+			default:
+			{
+				return "unknown";
+			}
+		}
+	}
+
+	std::string GetErrorMessage(MisbitFontAssembler::ErrorType error_type, MisbitFontAssembler::TokenType token_type, std::string_view token)
+	{
+		using MisbitFontAssembler::ErrorType;
+		switch (error_type)
+		{
+			case ErrorType::InvalidToken:
+			{
+				return fmt::format("Invalid Token '{}'", token);
+			}
+			case ErrorType::MissingOperand:
+			{
+				return fmt::format("Missing Operand for {}", GetTokenName(token_type));
+			}
+			case ErrorType::InvalidValue:
+			{
+				return "Invalid Value";
+			}
+			case ErrorType::IllegalToken:
+			{
+				return "Illegal Token being used when drawing.";
+			}
+			case ErrorType::UnsupportedPaletteFormat:
+			{
+				return "Palette Format being specified is unsupported (must be between 1 and 8).";
+			}
+			case ErrorType::UnsupportedMaxFontSize:
+			{
+				return "Max Font Size being specified is unsupported (both width and height must be between 1 and 256).";
+			}
+			case ErrorType::StringRequirement:
+			{
+				return fmt::format("{} must be stored as a string.", GetTokenName(token_type));
+			}
+			case ErrorType::UnterminatedString:
+			{
+				return "Unterminated String";
+			}
+			case ErrorType::IncludeFailed:
+			{
+				return fmt::format("Unable to open included file '{}'.", token);
+			}
+			case ErrorType::IncludeCycle:
+			{
+				return fmt::format("'{}' includes itself.", token);
+			}
+			case ErrorType::UndrawnCharacter:
+			{
+				return token.empty() ? std::string("There is no character to repeat yet.") : fmt::format("Character {} has not been drawn yet.", token);
+			}
+			case ErrorType::StreamedCharacter:
+			{
+				return fmt::format("Character {} has already been streamed out.  Only the last character can be copied when streaming.", token);
+			}
+			case ErrorType::FileAccessDisabled:
+			{
+				return fmt::format("Unable to open '{}', as opening files is not allowed for this source.", token);
+			}
+			case ErrorType::ImportFailed:
+			{
+				return fmt::format("Unable to open sheet '{}'.", token);
+			}
+			case ErrorType::InvalidSheet:
+			{
+				return fmt::format("'{}' is not a binary PBM or PGM image.", token);
+			}
+			case ErrorType::TruncatedSheet:
+			{
+				return fmt::format("'{}' has less pixel data than its header describes.", token);
+			}
+			case ErrorType::SheetTooSmall:
+			{
+				return fmt::format("'{}' is too small for the number of characters being imported from it.", token);
+			}
+			case ErrorType::TooManyCharacters:
+			{
+				return "A font cannot hold more than 4294967295 characters.";
+			}
+			case ErrorType::NotBdf:
+			{
+				return "The input is not a BDF font (it must start with STARTFONT).";
+			}
+			case ErrorType::BdfOutOfPlace:
+			{
+				return fmt::format("{} is out of place in a BDF font.", token);
+			}
+			case ErrorType::BdfMissingBoundingBox:
+			{
+				return "FONTBOUNDINGBOX must be given before the first character.";
+			}
+			case ErrorType::ThreadStartFailed:
+			{
+				return "Unable to start the threads to decode characters on.";
+			}
+			default:
+			{
+				return "Unknown Error";
+			}
+		}
+	}
+
+	void AppendJsonString(fmt::memory_buffer &Output, std::string_view text)
+	{
+		Output.push_back('"');
+		for (char c : text)
+		{
+			switch (c)
+			{
+				case '"':
+				case '\\':
+				{
+					Output.push_back('\\');
+					Output.push_back(c);
+					break;
+				}
+				case '\n':
+				{
+					fmt::format_to(std::back_inserter(Output), "\\n");
+					break;
+				}
+				case '\t':
+				{
+					fmt::format_to(std::back_inserter(Output), "\\t");
+					break;
+				}
+				default:
+				{
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						fmt::format_to(std::back_inserter(Output), "\\u{:04x}", static_cast<unsigned char>(c));
+					}
+					else
+					{
+						Output.push_back(c);
+					}
+					break;
+				}
+			}
+		}
+		Output.push_back('"');
+	}
+}
+
+MisbitFontAssembler::Diagnostics::Diagnostics(const DiagnosticsOptions &Options, std::string_view file) : Options(Options), file(file), LastWarningLine {}, SuppressedWarnings {}, error_count(0), warning_count(0), shown_warning_count(0)
+{
+}
+
+void MisbitFontAssembler::Diagnostics::Message(std::string_view message)
+{
+	if (Options.format == DiagnosticsFormat::Json)
+	{
+		if (!message.empty())
+		{
+			WriteJson("message", "", 0, 0, message);
+		}
+		return;
+	}
+	fmt::format_to(std::back_inserter(Output), "{}\n", message);
+}
+
+void MisbitFontAssembler::Diagnostics::Warning(size_t line, size_t column, WarningType warning_type, DrawMode draw_mode)
+{
+	++warning_count;
+	size_t index = static_cast<size_t>(warning_type);
+	// Lines start at 1, so a last line of 0 means this kind has not been seen yet.
+	bool repeated = (LastWarningLine[index] == line);
+	LastWarningLine[index] = line;
+	if (repeated || shown_warning_count >= Options.max_warnings)
+	{
+		++SuppressedWarnings[index];
+		return;
+	}
+	++shown_warning_count;
+	const WarningInfo &Info = WarningList[index];
+	std::string message = fmt::format(fmt::runtime(Info.message), GetDigitRange(draw_mode), GetDrawModeName(draw_mode));
+	if (Options.format == DiagnosticsFormat::Json)
+	{
+		WriteJson("warning", Info.kind, line, column, message);
+		return;
+	}
+	fmt::format_to(std::back_inserter(Output), "Warning at {}{}:{} : {}\n", GetLocationPrefix(), line, column, message);
+}
+
+void MisbitFontAssembler::Diagnostics::Error(size_t line, size_t column, ErrorType error_type, TokenType token_type, std::string_view token)
+{
+	++error_count;
+	std::string message = GetErrorMessage(error_type, token_type, token);
+	if (Options.format == DiagnosticsFormat::Json)
+	{
+		WriteJson("error", GetErrorKind(error_type), line, column, message);
+		return;
+	}
+	fmt::format_to(std::back_inserter(Output), "Error at {}{}:{} : {}\n", GetLocationPrefix(), line, column, message);
+}
+
+void MisbitFontAssembler::Diagnostics::Summarize(bool success)
+{
+	size_t suppressed_count = warning_count - shown_warning_count;
+	if (Options.format == DiagnosticsFormat::Json)
+	{
+		fmt::format_to(std::back_inserter(Output), "{{\"file\":");
+		AppendJsonString(Output, file);
+		fmt::format_to(std::back_inserter(Output), ",\"type\":\"summary\",\"success\":{},\"errors\":{},\"warnings\":{},\"suppressed_warnings\":{{", success, error_count, warning_count);
+		bool first = true;
+		for (size_t i = 0; i < SuppressedWarnings.size(); ++i)
+		{
+			if (SuppressedWarnings[i])
+			{
+				fmt::format_to(std::back_inserter(Output), "{}\"{}\":{}", first ? "" : ",", WarningList[i].kind, SuppressedWarnings[i]);
+				first = false;
+			}
+		}
+		fmt::format_to(std::back_inserter(Output), "}}}}\n");
+		return;
+	}
+	if (suppressed_count == 0)
+	{
+		return;
+	}
+	fmt::format_to(std::back_inserter(Output), "{} warning{} {} not shown (repeated on the same line or beyond the warning limit):\n", suppressed_count, (suppressed_count != 1) ? "s" : "", (suppressed_count != 1) ? "were" : "was");
+	for (size_t i = 0; i < SuppressedWarnings.size(); ++i)
+	{
+		if (SuppressedWarnings[i])
+		{
+			fmt::format_to(std::back_inserter(Output), "  {} x {}\n", SuppressedWarnings[i], WarningList[i].kind);
+		}
+	}
+}
+
+// Discards every warning and error, along with the output collected since GetOutputSize() returned output_size.
+void MisbitFontAssembler::Diagnostics::Reset(size_t output_size)
+{
+	Output.resize(output_size);
+	included_file.clear();
+	LastWarningLine.fill(0);
+	SuppressedWarnings.fill(0);
+	error_count = 0;
+	warning_count = 0;
+	shown_warning_count = 0;
+}
+
+// Starts over for another file, keeping the output buffer.
+void MisbitFontAssembler::Diagnostics::Reset(const DiagnosticsOptions &Options, std::string_view file)
+{
+	this->Options = Options;
+	this->file = file;
+	Reset();
+}
+
+// Attributes the following warnings and errors to an included file, or back to the file itself when empty.
+void MisbitFontAssembler::Diagnostics::SetIncludedFile(std::string_view included_file)
+{
+	this->included_file = included_file;
+	// Repeats are only suppressed on the same line of the same file.
+	LastWarningLine.fill(0);
+}
+
+size_t MisbitFontAssembler::Diagnostics::GetErrorCount() const
+{
+	return error_count;
+}
+
+size_t MisbitFontAssembler::Diagnostics::GetWarningCount() const
+{
+	return warning_count;
+}
+
+size_t MisbitFontAssembler::Diagnostics::GetOutputSize() const
+{
+	return Output.size();
+}
+
+std::string_view MisbitFontAssembler::Diagnostics::GetOutput() const
+{
+	return std::string_view(Output.data(), Output.size());
+}
+
+void MisbitFontAssembler::Diagnostics::Flush(std::FILE *stream)
+{
+	fwrite(Output.data(), 1, Output.size(), stream);
+	fflush(stream);
+	Output.clear();
+}
+
+std::string MisbitFontAssembler::Diagnostics::GetLocationPrefix() const
+{
+	return included_file.empty() ? "" : fmt::format("{}:", included_file);
+}
+
+void MisbitFontAssembler::Diagnostics::WriteJson(std::string_view type, std::string_view kind, size_t line, size_t column, std::string_view message)
+{
+	fmt::format_to(std::back_inserter(Output), "{{\"file\":");
+	AppendJsonString(Output, included_file.empty() ? std::string_view(file) : std::string_view(included_file));
+	fmt::format_to(std::back_inserter(Output), ",\"type\":\"{}\"", type);
+	if (!kind.empty())
+	{
+		fmt::format_to(std::back_inserter(Output), ",\"kind\":\"{}\",\"line\":{},\"column\":{}", kind, line, column);
+	}
+	fmt::format_to(std::back_inserter(Output), ",\"message\":");
+	AppendJsonString(Output, message);
+	fmt::format_to(std::back_inserter(Output), "}}\n");
+}
@@ -0,0 +1,148 @@
+#include "../include/font_reader.hpp"
+#include "../include/source_writer.hpp"
+#include "../include/keywords.hpp"
+#include <optional>
+#include <filesystem>
+#include <fmt/core.h>
+
+namespace
+{
+	using namespace MisbitFontAssembler;
+
+	struct DisassemblerOptions
+	{
+		std::string input_path;
+		std::string output_path;
+		std::optional<DrawMode> draw_mode;
+	};
+
+	void PrintFormat()
+	{
+		fmt::print("Format:  misbitfont_disassembler [options] [input] -o [output]\n");
+		fmt::print("         --draw-mode [mode]          Draw mode to write characters in (default depends on the palette format).\n");
+	}
+
+	bool ParseArguments(int argc, char *argv[], DisassemblerOptions &Options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string_view option = argv[i];
+			if (option == "--help")
+			{
+				PrintFormat();
+				return false;
+			}
+			if (option != "-o" && option != "--draw-mode")
+			{
+				if (!Options.input_path.empty())
+				{
+					PrintFormat();
+					return false;
+				}
+				Options.input_path = option;
+				continue;
+			}
+			if (i + 1 >= argc)
+			{
+				fmt::print("Missing value for '{}'.\n", option);
+				return false;
+			}
+			std::string_view value = argv[++i];
+			if (option == "-o")
+			{
+				Options.output_path = value;
+			}
+			else
+			{
+				const DrawMode *Mode = DrawModeList.Find(value);
+				if (!Mode)
+				{
+					fmt::print("Invalid value '{}' for '{}'.\n", value, option);
+					return false;
+				}
+				Options.draw_mode = *Mode;
+			}
+		}
+		if (Options.input_path.empty() || Options.output_path.empty())
+		{
+			PrintFormat();
+			return false;
+		}
+		return true;
+	}
+
+	// The mode that needs the fewest digits per pixel, favouring octal where it lines up with the palette format.
+	DrawMode GetDefaultDrawMode(uint8_t palette_format)
+	{
+		switch (palette_format)
+		{
+			case 1:
+			{
+				return DrawMode::Binary;
+			}
+			case 3:
+			case 6:
+			{
+				return DrawMode::Octal;
+			}
+			default:
+			{
+				return DrawMode::Hexadecimal;
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	DisassemblerOptions Options;
+	if (!ParseArguments(argc, argv, Options))
+	{
+		return -1;
+	}
+	if (Options.output_path == Options.input_path)
+	{
+		fmt::print("Do not specify the output file as the input file ('{}').\n", Options.input_path);
+		return -1;
+	}
+	FontReader Font;
+	switch (Font.Open(Options.input_path))
+	{
+		case FontReadResult::Success:
+		{
+			break;
+		}
+		case FontReadResult::OpenFailed:
+		{
+			fmt::print("Unable to open '{}'.\n", Options.input_path);
+			return -1;
+		}
+		case FontReadResult::InvalidHeader:
+		{
+			fmt::print("'{}' is not a supported MisbitFont file.\n", Options.input_path);
+			return -1;
+		}
+		case FontReadResult::Truncated:
+		{
+			fmt::print("'{}' is shorter than its header says.\n", Options.input_path);
+			return -1;
+		}
+	}
+	SourceWriter Writer(Options.draw_mode.value_or(GetDefaultDrawMode(Font.GetSettings().palette_format)));
+	if (!Writer.Write(Font, Options.output_path, fmt::format("Disassembled from {}", std::filesystem::path(Options.input_path).filename().string())))
+	{
+		fmt::print("Unable to write '{}'.\n", Options.output_path);
+		return -1;
+	}
+	size_t character_count = Font.GetCount();
+	fmt::print("{} character{} {} disassembled to {}.\n", character_count, (character_count != 1) ? "s" : "", (character_count != 1) ? "were" : "was", Options.output_path);
+	if (Font.HasTrailingData())
+	{
+		fmt::print("Warning: '{}' has data after its last character, which will not be reassembled.\n", Options.input_path);
+	}
+	if (Writer.GetInexactCount() > 0)
+	{
+		fmt::print("Warning: {} character{} or name{} cannot be reassembled exactly as stored (pixels beyond a character's width, a width above the maximum font width, or quotes and line breaks in a name).\n", Writer.GetInexactCount(), (Writer.GetInexactCount() != 1) ? "s" : "", (Writer.GetInexactCount() != 1) ? "s" : "");
+	}
+	return 0;
+}
@@ -0,0 +1,370 @@
+#include "../include/emitter.hpp"
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <filesystem>
+#include <fmt/core.h>
+#include <msbtfont/msbtfont.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+namespace
+{
+	void CreateHeader(const MisbitFontAssembler::FontData &Font, msbtfont_header &header)
+	{
+		const MisbitFontAssembler::FontSettings &Settings = Font.Settings;
+		msbtfont_header_descriptor header_descriptor;
+		memset(&header_descriptor, 0, sizeof(msbtfont_header_descriptor));
+		header_descriptor.palette_format = Settings.palette_format - 1;
+		header_descriptor.max_font_width = static_cast<uint8_t>(Settings.max_font_size.width - 1);
+		header_descriptor.max_font_height = static_cast<uint8_t>(Settings.max_font_size.height - 1);
+		if (Settings.spacing_type == MisbitFontAssembler::SpacingType::Variable)
+		{
+			header_descriptor.flags |= 0x01;
+		}
+		header_descriptor.font_character_count = Font.FontCharacterTable.GetCount();
+		memcpy(header_descriptor.font_name, Settings.font_name.c_str(), std::min<size_t>(Settings.font_name.size(), 64));
+		memcpy(header_descriptor.language, Settings.language.c_str(), std::min<size_t>(Settings.language.size(), 64));
+		msbtfont_create_header(&header, &header_descriptor);
+	}
+
+	// Including the alternative tokens, which cannot be used as identifiers either.
+	constexpr std::array<std::string_view, 93> Keywords = {
+		"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case",
+		"catch", "char", "char16_t", "char32_t", "char8_t", "class", "co_await", "co_return", "co_yield",
+		"compl", "concept", "const", "const_cast", "consteval", "constexpr", "constinit", "continue",
+		"decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit",
+		"export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+		"mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq",
+		"private", "protected", "public", "register", "reinterpret_cast", "requires", "return", "short",
+		"signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template",
+		"this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+		"unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq", "std"
+	};
+
+	// Names the generated namespace, replacing anything that cannot appear in an identifier.  Names that
+	// would start with a digit or are C++ keywords (or std) are prefixed with font_.
+	std::string MakeIdentifier(std::string_view name)
+	{
+		std::string identifier;
+		for (char c : name)
+		{
+			bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+			identifier.push_back(valid ? c : '_');
+		}
+		if (identifier.empty() || (identifier[0] >= '0' && identifier[0] <= '9') || std::find(Keywords.begin(), Keywords.end(), identifier) != Keywords.end())
+		{
+			identifier.insert(0, "font_");
+		}
+		return identifier;
+	}
+
+	// Octal escapes always take three digits, so they cannot run into the character after them.
+	void AppendStringLiteral(std::string &Output, std::string_view text)
+	{
+		Output.push_back('"');
+		for (char c : text.substr(0, 64))
+		{
+			uint8_t byte = static_cast<uint8_t>(c);
+			if (byte >= 0x20 && byte < 0x7F && c != '"' && c != '\\' && c != '?')
+			{
+				Output.push_back(c);
+			}
+			else
+			{
+				Output += fmt::format("\\{:03o}", byte);
+			}
+		}
+		Output.push_back('"');
+	}
+
+	void AppendByteArray(std::string &Output, std::string_view name, const uint8_t *data, size_t size)
+	{
+		Output += fmt::format("\tinline constexpr std::array<std::uint8_t, {}> {} = {{", size, name);
+		for (size_t i = 0; i < size; ++i)
+		{
+			Output += (i % 16) ? " 0x" : "\n\t\t0x";
+			Output.push_back("0123456789ABCDEF"[data[i] >> 4]);
+			Output.push_back("0123456789ABCDEF"[data[i] & 0x0F]);
+			if (i + 1 < size)
+			{
+				Output.push_back(',');
+			}
+		}
+		Output += size ? "\n\t};\n" : "};\n";
+	}
+
+	// A file that could not be written in full is removed rather than left behind as a partial font.
+	bool CloseOutput(std::FILE *output_file, const std::string &path, bool written)
+	{
+		if (path == "-")
+		{
+			return (std::fflush(output_file) == 0) && written;
+		}
+		bool closed = (std::fclose(output_file) == 0);
+		if (!closed || !written)
+		{
+			std::error_code error;
+			if (std::filesystem::is_regular_file(path, error))
+			{
+				std::filesystem::remove(path, error);
+			}
+			return false;
+		}
+		return true;
+	}
+
+	void SetBinaryMode(std::FILE *stream)
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stream), _O_BINARY);
+#else
+		static_cast<void>(stream);
+#endif
+	}
+}
+
+MisbitFontAssembler::Emitter::Emitter(Statistics *Stats) : Stats(Stats)
+{
+}
+
+bool MisbitFontAssembler::Emitter::Write(const FontData &Font, const std::string &path)
+{
+	PhaseScope WriteScope(Stats, Phase::Write);
+	// '-' writes to standard output, which is only ever written in order.
+	bool standard_output = (path == "-");
+	if (standard_output)
+	{
+		SetBinaryMode(stdout);
+	}
+	std::FILE *output_file = standard_output ? stdout : std::fopen(path.c_str(), "wb");
+	if (!output_file)
+	{
+		return false;
+	}
+	const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	msbtfont_header header;
+	{
+		PhaseScope HeaderScope(Stats, Phase::Header);
+		CreateHeader(Font, header);
+	}
+	size_t variable_table_size = (Font.Settings.spacing_type == SpacingType::Variable) ? FontCharacterTable.GetVariableTableSize() : 0;
+	// The arena already matches the file's layout, so it is written out without going through msbtfont_filedata.
+	bool written = std::fwrite(&header, 1, sizeof(header), output_file) == sizeof(header);
+	written = written && std::fwrite(FontCharacterTable.GetVariableTable(), 1, variable_table_size, output_file) == variable_table_size;
+	written = written && std::fwrite(FontCharacterTable.GetFontData(), 1, FontCharacterTable.GetFontDataSize(), output_file) == FontCharacterTable.GetFontDataSize();
+	if (Stats)
+	{
+		Stats->Count(Counter::BytesWritten, sizeof(header) + variable_table_size + FontCharacterTable.GetFontDataSize());
+	}
+	return CloseOutput(output_file, path, written);
+}
+
+void MisbitFontAssembler::Emitter::Write(const FontData &Font, std::vector<uint8_t> &Output)
+{
+	PhaseScope WriteScope(Stats, Phase::Write);
+	const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	msbtfont_header header;
+	{
+		PhaseScope HeaderScope(Stats, Phase::Header);
+		CreateHeader(Font, header);
+	}
+	size_t variable_table_size = (Font.Settings.spacing_type == SpacingType::Variable) ? FontCharacterTable.GetVariableTableSize() : 0;
+	const uint8_t *header_bytes = reinterpret_cast<const uint8_t *>(&header);
+	Output.clear();
+	Output.reserve(sizeof(header) + variable_table_size + FontCharacterTable.GetFontDataSize());
+	Output.insert(Output.end(), header_bytes, header_bytes + sizeof(header));
+	Output.insert(Output.end(), FontCharacterTable.GetVariableTable(), FontCharacterTable.GetVariableTable() + variable_table_size);
+	Output.insert(Output.end(), FontCharacterTable.GetFontData(), FontCharacterTable.GetFontData() + FontCharacterTable.GetFontDataSize());
+	if (Stats)
+	{
+		Stats->Count(Counter::BytesWritten, Output.size());
+	}
+}
+
+bool MisbitFontAssembler::Emitter::WriteCxxHeader(const FontData &Font, const std::string &path, std::string_view name)
+{
+	PhaseScope WriteScope(Stats, Phase::Write);
+	const FontSettings &Settings = Font.Settings;
+	const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	msbtfont_header header;
+	{
+		PhaseScope HeaderScope(Stats, Phase::Header);
+		CreateHeader(Font, header);
+	}
+	std::string identifier = MakeIdentifier(name);
+	std::string guard = identifier;
+	std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c; });
+	bool variable = (Settings.spacing_type == SpacingType::Variable);
+	std::string Output;
+	Output.reserve(((sizeof(header) + FontCharacterTable.GetVariableTableSize() + FontCharacterTable.GetFontDataSize()) * 6) + 4096);
+	Output += "// Generated by MisbitFont Assembler.  Do not edit.\n";
+	Output += fmt::format("#ifndef _MISBITFONT_{}_HPP_\n#define _MISBITFONT_{}_HPP_\n\n", guard, guard);
+	Output += "#include <array>\n#include <string_view>\n#include <cstddef>\n#include <cstdint>\n\n";
+	Output += fmt::format("namespace {}\n{{\n", identifier);
+	Output += "\t// The bytes of the MisbitFont file, split into its header, variable table and font data.\n";
+	AppendByteArray(Output, "header", reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+	AppendByteArray(Output, "variable_table", FontCharacterTable.GetVariableTable(), variable ? FontCharacterTable.GetVariableTableSize() : 0);
+	AppendByteArray(Output, "font_data", FontCharacterTable.GetFontData(), FontCharacterTable.GetFontDataSize());
+	Output += "\n";
+	Output += fmt::format("\tinline constexpr std::uint8_t palette_format = {};\n", Settings.palette_format);
+	Output += fmt::format("\tinline constexpr std::uint16_t max_font_width = {};\n", Settings.max_font_size.width);
+	Output += fmt::format("\tinline constexpr std::uint16_t max_font_height = {};\n", Settings.max_font_size.height);
+	Output += fmt::format("\tinline constexpr bool variable_spacing = {};\n", variable);
+	Output += fmt::format("\tinline constexpr std::uint32_t character_count = {};\n", FontCharacterTable.GetCount());
+	Output += fmt::format("\tinline constexpr std::size_t character_bits = {};\n", FontCharacterTable.GetCharacterBits());
+	Output += "\tinline constexpr std::string_view font_name = ";
+	AppendStringLiteral(Output, Settings.font_name);
+	Output += ";\n\tinline constexpr std::string_view language = ";
+	AppendStringLiteral(Output, Settings.language);
+	Output += ";\n\n";
+	Output += "\t// Where a character starts in font_data.  Its pixels follow row by row, palette_format bits each, most significant bit first.\n";
+	Output += "\tconstexpr std::size_t GetCharacterBitOffset(std::uint32_t index)\n\t{\n\t\treturn index * character_bits;\n\t}\n\n";
+	Output += "\tconstexpr std::uint16_t GetCharacterWidth(std::uint32_t index)\n\t{\n";
+	Output += variable ? "\t\treturn static_cast<std::uint16_t>(variable_table[index] + 1);\n\t}\n\n" : "\t\tstatic_cast<void>(index);\n\t\treturn max_font_width;\n\t}\n\n";
+	Output += "\tconstexpr std::uint8_t GetPixel(std::uint32_t index, std::uint16_t x, std::uint16_t y)\n\t{\n";
+	Output += "\t\tstd::size_t bit = GetCharacterBitOffset(index) + (((static_cast<std::size_t>(y) * max_font_width) + x) * palette_format);\n";
+	Output += "\t\tstd::uint8_t value = 0;\n";
+	Output += "\t\tfor (std::uint8_t i = 0; i < palette_format; ++i, ++bit)\n\t\t{\n";
+	Output += "\t\t\tvalue = static_cast<std::uint8_t>((value << 1) | ((font_data[bit / 8] >> (7 - (bit % 8))) & 0x01));\n\t\t}\n";
+	Output += "\t\treturn value;\n\t}\n}\n\n#endif\n";
+	bool standard_output = (path == "-");
+	std::FILE *output_file = standard_output ? stdout : std::fopen(path.c_str(), "wb");
+	if (!output_file)
+	{
+		return false;
+	}
+	bool written = std::fwrite(Output.data(), 1, Output.size(), output_file) == Output.size();
+	if (Stats)
+	{
+		Stats->Count(Counter::BytesWritten, Output.size());
+	}
+	return CloseOutput(output_file, path, written);
+}
+
+MisbitFontAssembler::StreamEmitter::StreamEmitter(Statistics *Stats) : Stats(Stats), font_data_spill(nullptr), good(true)
+{
+}
+
+MisbitFontAssembler::StreamEmitter::~StreamEmitter()
+{
+	if (font_data_spill)
+	{
+		std::fclose(font_data_spill);
+	}
+}
+
+bool MisbitFontAssembler::StreamEmitter::Open(const std::string &path)
+{
+	PhaseScope WriteScope(Stats, Phase::Write);
+	this->path = path;
+	OutputFile.open(path, std::ios::binary);
+	if (!OutputFile.is_open())
+	{
+		return false;
+	}
+	// Placeholder, rewritten by Finish() once the character count is known.
+	msbtfont_header header;
+	memset(&header, 0, sizeof(msbtfont_header));
+	WriteOutput(&header, sizeof(header));
+	return OutputFile.good();
+}
+
+void MisbitFontAssembler::StreamEmitter::WriteCharacters(FontData &Font)
+{
+	GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	if (!good)
+	{
+		return;
+	}
+	PhaseScope WriteScope(Stats, Phase::Write);
+	if (Font.Settings.spacing_type == SpacingType::Variable)
+	{
+		// The variable table sits between the header and the font data, so the font data waits in a temporary file.
+		if (!font_data_spill)
+		{
+			font_data_spill = std::tmpfile();
+			if (!font_data_spill)
+			{
+				good = false;
+				return;
+			}
+		}
+		WriteOutput(FontCharacterTable.GetVariableTable(), FontCharacterTable.GetVariableTableSize());
+		size_t complete_size = FontCharacterTable.GetCompleteFontDataSize();
+		if (std::fwrite(FontCharacterTable.GetFontData(), 1, complete_size, font_data_spill) != complete_size)
+		{
+			good = false;
+		}
+		if (Stats)
+		{
+			Stats->Count(Counter::BytesWritten, complete_size);
+		}
+	}
+	else
+	{
+		WriteOutput(FontCharacterTable.GetFontData(), FontCharacterTable.GetCompleteFontDataSize());
+	}
+	FontCharacterTable.Release();
+	good = good && OutputFile.good();
+}
+
+bool MisbitFontAssembler::StreamEmitter::Finish(const FontData &Font)
+{
+	const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	if (!good)
+	{
+		return false;
+	}
+	PhaseScope WriteScope(Stats, Phase::Write);
+	if (font_data_spill)
+	{
+		WriteOutput(FontCharacterTable.GetVariableTable(), FontCharacterTable.GetVariableTableSize());
+		std::rewind(font_data_spill);
+		std::vector<char> Buffer(1 << 20);
+		size_t read_size;
+		// Already counted as written when it was spilled.
+		while ((read_size = std::fread(Buffer.data(), 1, Buffer.size(), font_data_spill)) > 0)
+		{
+			OutputFile.write(Buffer.data(), read_size);
+		}
+		if (std::ferror(font_data_spill))
+		{
+			return false;
+		}
+	}
+	WriteOutput(FontCharacterTable.GetFontData(), FontCharacterTable.GetFontDataSize());
+	msbtfont_header header;
+	{
+		PhaseScope HeaderScope(Stats, Phase::Header);
+		CreateHeader(Font, header);
+	}
+	OutputFile.seekp(0);
+	OutputFile.write(reinterpret_cast<char *>(&header), sizeof(header));
+	OutputFile.close();
+	return !OutputFile.fail();
+}
+
+void MisbitFontAssembler::StreamEmitter::Discard()
+{
+	if (OutputFile.is_open())
+	{
+		OutputFile.close();
+	}
+	std::error_code error;
+	if (std::filesystem::is_regular_file(path, error))
+	{
+		std::filesystem::remove(path, error);
+	}
+}
+
+void MisbitFontAssembler::StreamEmitter::WriteOutput(const void *data, size_t size)
+{
+	OutputFile.write(reinterpret_cast<const char *>(data), size);
+	if (Stats)
+	{
+		Stats->Count(Counter::BytesWritten, size);
+	}
+}
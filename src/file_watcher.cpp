@@ -0,0 +1,99 @@
+#include "../include/file_watcher.hpp"
+#include <thread>
+#include <chrono>
+#include <array>
+#include <cerrno>
+#if __has_include(<sys/inotify.h>)
+#define MISBITFONT_ASSEMBLER_USE_INOTIFY
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+MisbitFontAssembler::FileWatcher::FileWatcher() : inotify_descriptor(-1)
+{
+}
+
+MisbitFontAssembler::FileWatcher::~FileWatcher()
+{
+#ifdef MISBITFONT_ASSEMBLER_USE_INOTIFY
+	if (inotify_descriptor != -1)
+	{
+		close(inotify_descriptor);
+	}
+#endif
+}
+
+bool MisbitFontAssembler::FileWatcher::Open(const std::string &path)
+{
+	std::error_code error;
+	file_path = std::filesystem::absolute(path, error);
+	if (error)
+	{
+		return false;
+	}
+	last_write_time = std::filesystem::last_write_time(file_path, error);
+#ifdef MISBITFONT_ASSEMBLER_USE_INOTIFY
+	inotify_descriptor = inotify_init1(IN_CLOEXEC);
+	if (inotify_descriptor == -1)
+	{
+		return false;
+	}
+	return inotify_add_watch(inotify_descriptor, file_path.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) != -1;
+#else
+	return true;
+#endif
+}
+
+bool MisbitFontAssembler::FileWatcher::Wait()
+{
+#ifdef MISBITFONT_ASSEMBLER_USE_INOTIFY
+	std::string file_name = file_path.filename().string();
+	alignas(inotify_event) std::array<char, 4096> Events;
+	bool changed = false;
+	// Once the file has changed, keep reading briefly so the burst of events from a single save is consumed at once.
+	while (true)
+	{
+		pollfd descriptor = { inotify_descriptor, POLLIN, 0 };
+		int ready = poll(&descriptor, 1, changed ? 50 : -1);
+		if (ready == 0)
+		{
+			return true;
+		}
+		if (ready == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		ssize_t length = read(inotify_descriptor, Events.data(), Events.size());
+		if (length <= 0)
+		{
+			return false;
+		}
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event *Event = reinterpret_cast<const inotify_event *>(Events.data() + offset);
+			if (Event->len && file_name == Event->name)
+			{
+				changed = true;
+			}
+			offset += sizeof(inotify_event) + Event->len;
+		}
+	}
+#else
+	while (true)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		std::error_code error;
+		std::filesystem::file_time_type write_time = std::filesystem::last_write_time(file_path, error);
+		if (!error && write_time != last_write_time)
+		{
+			last_write_time = write_time;
+			return true;
+		}
+	}
+#endif
+}
@@ -0,0 +1,112 @@
+#include "../include/font_reader.hpp"
+#include "../include/bit_reader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <msbtfont/msbtfont.h>
+
+namespace
+{
+	std::string ReadHeaderString(const char *text, size_t size)
+	{
+		return std::string(text, std::find(text, text + size, '\0'));
+	}
+}
+
+MisbitFontAssembler::FontReader::FontReader() : Settings { 1, { 1, 1 }, SpacingType::Monospace, "", "" }, variable_table(nullptr), font_data(nullptr), character_bits(0), trailing_data(false), count(0)
+{
+}
+
+MisbitFontAssembler::FontReader::~FontReader()
+{
+	Close();
+}
+
+MisbitFontAssembler::FontReadResult MisbitFontAssembler::FontReader::Open(const std::string &path)
+{
+	Close();
+	if (!File.Open(path))
+	{
+		return FontReadResult::OpenFailed;
+	}
+	const uint8_t *data = File.GetData();
+	size_t size = File.GetSize();
+	if (size < sizeof(msbtfont_header))
+	{
+		return FontReadResult::InvalidHeader;
+	}
+	msbtfont_header header;
+	memcpy(&header, data, sizeof(header));
+	msbtfont_header_descriptor header_descriptor;
+	memset(&header_descriptor, 0, sizeof(msbtfont_header_descriptor));
+	header_descriptor.palette_format = header.palette_format;
+	header_descriptor.max_font_width = header.max_font_width;
+	header_descriptor.max_font_height = header.max_font_height;
+	header_descriptor.flags = header.flags;
+	header_descriptor.font_character_count = header.font_character_count;
+	memcpy(header_descriptor.font_name, header.font_name, sizeof(header_descriptor.font_name));
+	memcpy(header_descriptor.language, header.language, sizeof(header_descriptor.language));
+	msbtfont_header expected_header;
+	if (header.palette_format > 7 || msbtfont_create_header(&expected_header, &header_descriptor) != 0 || memcmp(&expected_header, &header, sizeof(header)) != 0)
+	{
+		return FontReadResult::InvalidHeader;
+	}
+	Settings.palette_format = header.palette_format + 1;
+	Settings.max_font_size = { static_cast<uint16_t>(header.max_font_width + 1), static_cast<uint16_t>(header.max_font_height + 1) };
+	Settings.spacing_type = (header.flags & 0x01) ? SpacingType::Variable : SpacingType::Monospace;
+	Settings.font_name = ReadHeaderString(header.font_name, sizeof(header.font_name));
+	Settings.language = ReadHeaderString(header.language, sizeof(header.language));
+	count = header.font_character_count;
+	character_bits = static_cast<size_t>(Settings.max_font_size.width) * Settings.max_font_size.height * Settings.palette_format;
+	size_t variable_table_size = (Settings.spacing_type == SpacingType::Variable) ? count : 0;
+	size_t font_data_size = ((count * character_bits) + 7) / 8;
+	if (size - sizeof(header) < variable_table_size + font_data_size)
+	{
+		return FontReadResult::Truncated;
+	}
+	variable_table = data + sizeof(header);
+	font_data = variable_table + variable_table_size;
+	size_t padding_bits = (font_data_size * 8) - (count * character_bits);
+	trailing_data = (size - sizeof(header) > variable_table_size + font_data_size) || (padding_bits && (font_data[font_data_size - 1] & ((1u << padding_bits) - 1)));
+	return FontReadResult::Success;
+}
+
+void MisbitFontAssembler::FontReader::Close()
+{
+	File.Close();
+	variable_table = nullptr;
+	font_data = nullptr;
+	trailing_data = false;
+	count = 0;
+}
+
+const MisbitFontAssembler::FontSettings &MisbitFontAssembler::FontReader::GetSettings() const
+{
+	return Settings;
+}
+
+uint32_t MisbitFontAssembler::FontReader::GetCount() const
+{
+	return count;
+}
+
+size_t MisbitFontAssembler::FontReader::GetCharacterBits() const
+{
+	return character_bits;
+}
+
+// Set bits in the padding of the last byte, or bytes after the font data, neither of which an assembled file has.
+bool MisbitFontAssembler::FontReader::HasTrailingData() const
+{
+	return trailing_data;
+}
+
+// The width recorded in the variable table (1 - 256), or the maximum font width for monospace fonts.
+uint16_t MisbitFontAssembler::FontReader::GetWidth(uint32_t index) const
+{
+	return (Settings.spacing_type == SpacingType::Variable) ? static_cast<uint16_t>(variable_table[index] + 1) : Settings.max_font_size.width;
+}
+
+void MisbitFontAssembler::FontReader::UnpackCharacter(uint32_t index, uint8_t *pixels) const
+{
+	UnpackPixels(Settings.palette_format, font_data, index * character_bits, character_bits / Settings.palette_format, pixels);
+}
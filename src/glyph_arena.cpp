@@ -0,0 +1,207 @@
+#include "../include/glyph_arena.hpp"
+#include "../include/bit_writer.hpp"
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+	thread_local std::vector<uint8_t> StoreBuffer;
+}
+
+MisbitFontAssembler::GlyphArena::GlyphArena() : character_bits(1), released_bytes(0), released_count(0), count(0), last_width(0), palette_format(1), variable(false)
+{
+}
+
+void MisbitFontAssembler::GlyphArena::Configure(const FontSettings &Settings)
+{
+	palette_format = Settings.palette_format;
+	character_bits = static_cast<size_t>(Settings.max_font_size.width) * Settings.max_font_size.height * palette_format;
+	variable = (Settings.spacing_type == SpacingType::Variable);
+}
+
+uint32_t MisbitFontAssembler::GlyphArena::Append(const uint8_t *pixels, uint16_t width)
+{
+	if (!HasRoom(1))
+	{
+		return MaxCount;
+	}
+	size_t bit_offset = (count * character_bits) - (released_bytes * 8);
+	// Grows geometrically; the new bytes are zeroed, and only the first one can be shared with the previous character.
+	FontDataBytes.resize((bit_offset + character_bits + 7) / 8);
+	PackPixels(palette_format, pixels, character_bits / palette_format, FontDataBytes.data(), bit_offset);
+	if (variable)
+	{
+		VariableTable.push_back(static_cast<uint8_t>(width ? width - 1 : 0));
+	}
+	return count++;
+}
+
+uint32_t MisbitFontAssembler::GlyphArena::Reserve(uint16_t width)
+{
+	if (!HasRoom(1))
+	{
+		return MaxCount;
+	}
+	FontDataBytes.resize((((count + 1) * character_bits) - (released_bytes * 8) + 7) / 8);
+	if (variable)
+	{
+		VariableTable.push_back(static_cast<uint8_t>(width ? width - 1 : 0));
+	}
+	return count++;
+}
+
+void MisbitFontAssembler::GlyphArena::Store(uint32_t index, const uint8_t *pixels)
+{
+	size_t bit_offset = (index * character_bits) - (released_bytes * 8);
+	StoreBuffer.assign(((bit_offset % 8) + character_bits + 7) / 8, 0);
+	PackPixels(palette_format, pixels, character_bits / palette_format, StoreBuffer.data(), bit_offset % 8);
+	MergeStoreBuffer(bit_offset / 8);
+}
+
+// Stores a character already packed on its own (starting at bit 0), such as one from the glyph cache.
+void MisbitFontAssembler::GlyphArena::StorePacked(uint32_t index, const uint8_t *packed)
+{
+	size_t bit_offset = (index * character_bits) - (released_bytes * 8);
+	uint8_t shift = static_cast<uint8_t>(bit_offset % 8);
+	size_t packed_size = (character_bits + 7) / 8;
+	StoreBuffer.assign((shift + character_bits + 7) / 8, 0);
+	if (shift == 0)
+	{
+		memcpy(StoreBuffer.data(), packed, packed_size);
+	}
+	else
+	{
+		for (size_t i = 0; i < packed_size; ++i)
+		{
+			StoreBuffer[i] |= packed[i] >> shift;
+			if (i + 1 < StoreBuffer.size())
+			{
+				StoreBuffer[i + 1] = static_cast<uint8_t>(packed[i] << (8 - shift));
+			}
+		}
+	}
+	MergeStoreBuffer(bit_offset / 8);
+}
+
+// The counterpart of StorePacked(), copying a character out on its own starting at bit 0.
+void MisbitFontAssembler::GlyphArena::CopyPacked(uint32_t index, uint8_t *packed) const
+{
+	if (index < released_count)
+	{
+		memcpy(packed, LastCharacter.data(), LastCharacter.size());
+		return;
+	}
+	size_t bit_offset = (index * character_bits) - (released_bytes * 8);
+	uint8_t shift = static_cast<uint8_t>(bit_offset % 8);
+	size_t packed_size = (character_bits + 7) / 8;
+	size_t input_size = (shift + character_bits + 7) / 8;
+	const uint8_t *input = &FontDataBytes[bit_offset / 8];
+	for (size_t i = 0; i < packed_size; ++i)
+	{
+		packed[i] = static_cast<uint8_t>(input[i] << shift);
+		if (shift && i + 1 < input_size)
+		{
+			packed[i] |= input[i + 1] >> (8 - shift);
+		}
+	}
+	// The rest of the last byte belongs to the next character.
+	if (character_bits % 8)
+	{
+		packed[packed_size - 1] &= static_cast<uint8_t>(0xFF << (8 - (character_bits % 8)));
+	}
+}
+
+// Whether added more characters still fit in the 32-bit character count.
+bool MisbitFontAssembler::GlyphArena::HasRoom(uint64_t added) const
+{
+	return count + added <= MaxCount;
+}
+
+// Whether CopyPacked() can copy out a character, which is no longer the case once it was released (except for the last one).
+bool MisbitFontAssembler::GlyphArena::IsHeld(uint32_t index) const
+{
+	return index < count && (index >= released_count || (index + 1 == count && !LastCharacter.empty()));
+}
+
+uint16_t MisbitFontAssembler::GlyphArena::GetWidth(uint32_t index) const
+{
+	if (!variable)
+	{
+		return 0;
+	}
+	return static_cast<uint16_t>(((index < released_count) ? last_width : VariableTable[index - released_count]) + 1);
+}
+
+uint32_t MisbitFontAssembler::GlyphArena::GetCount() const
+{
+	return count;
+}
+
+size_t MisbitFontAssembler::GlyphArena::GetCharacterBits() const
+{
+	return character_bits;
+}
+
+size_t MisbitFontAssembler::GlyphArena::GetFontDataSize() const
+{
+	return FontDataBytes.size();
+}
+
+// Bytes that no later character can share.
+size_t MisbitFontAssembler::GlyphArena::GetCompleteFontDataSize() const
+{
+	return ((count * character_bits) / 8) - released_bytes;
+}
+
+size_t MisbitFontAssembler::GlyphArena::GetVariableTableSize() const
+{
+	return VariableTable.size();
+}
+
+const uint8_t *MisbitFontAssembler::GlyphArena::GetFontData() const
+{
+	return FontDataBytes.data();
+}
+
+const uint8_t *MisbitFontAssembler::GlyphArena::GetVariableTable() const
+{
+	return VariableTable.data();
+}
+
+void MisbitFontAssembler::GlyphArena::Release()
+{
+	if (count > released_count)
+	{
+		LastCharacter.resize((character_bits + 7) / 8);
+		CopyPacked(count - 1, LastCharacter.data());
+		last_width = variable ? VariableTable.back() : 0;
+		released_count = count;
+	}
+	size_t complete_size = GetCompleteFontDataSize();
+	FontDataBytes.erase(FontDataBytes.begin(), FontDataBytes.begin() + complete_size);
+	released_bytes += complete_size;
+	VariableTable.clear();
+}
+
+void MisbitFontAssembler::GlyphArena::Clear()
+{
+	FontDataBytes.clear();
+	VariableTable.clear();
+	LastCharacter.clear();
+	released_bytes = 0;
+	released_count = 0;
+	count = 0;
+}
+
+void MisbitFontAssembler::GlyphArena::MergeStoreBuffer(size_t first_byte)
+{
+	// The first and last bytes may be shared with the neighbouring characters, whose bits are disjoint from these.
+	size_t byte_count = StoreBuffer.size();
+	uint8_t *output = &FontDataBytes[first_byte];
+	std::atomic_ref<uint8_t>(output[0]).fetch_or(StoreBuffer[0]);
+	if (byte_count > 1)
+	{
+		memcpy(output + 1, StoreBuffer.data() + 1, byte_count - 2);
+		std::atomic_ref<uint8_t>(output[byte_count - 1]).fetch_or(StoreBuffer[byte_count - 1]);
+	}
+}
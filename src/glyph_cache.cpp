@@ -0,0 +1,195 @@
+#include "../include/glyph_cache.hpp"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+namespace
+{
+	constexpr char CacheMagic[8] = { 'M', 'S', 'B', 'T', 'G', 'C', '0', '1' };
+
+	uint64_t Mix(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+		return value;
+	}
+
+	uint64_t Rotate(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	template <typename T>
+	bool ReadValue(const std::vector<char> &Data, size_t &position, T &value)
+	{
+		if (Data.size() - position < sizeof(T))
+		{
+			return false;
+		}
+		memcpy(&value, Data.data() + position, sizeof(T));
+		position += sizeof(T);
+		return true;
+	}
+
+	template <typename T>
+	void WriteValue(std::ofstream &output_file, const T &value)
+	{
+		output_file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+}
+
+MisbitFontAssembler::GlyphKey MisbitFontAssembler::HashCharacter(const std::string_view *lines, size_t line_count, const FontSettings &Settings, DrawMode draw_mode, uint16_t width)
+{
+	// Two independent lanes over 8 bytes at a time; hashing has to stay well below the cost of decoding.
+	uint64_t state = Settings.palette_format | (static_cast<uint64_t>(Settings.max_font_size.width) << 8) | (static_cast<uint64_t>(Settings.max_font_size.height) << 24) | (static_cast<uint64_t>(draw_mode) << 40) | (static_cast<uint64_t>(width) << 44) | (static_cast<uint64_t>(Settings.spacing_type) << 60);
+	uint64_t low = Mix(state ^ 0x9E3779B97F4A7C15ull);
+	uint64_t high = Mix(state ^ 0xD6E8FEB86659FD93ull) ^ line_count;
+	for (size_t l = 0; l < line_count; ++l)
+	{
+		std::string_view line = lines[l];
+		size_t i = 0;
+		for (; i + 8 <= line.size(); i += 8)
+		{
+			uint64_t chunk;
+			memcpy(&chunk, line.data() + i, sizeof(chunk));
+			low = Rotate(low ^ chunk, 29) * 0x9FB21C651E98DF25ull;
+			high = Rotate(high + chunk, 37) * 0xC2B2AE3D27D4EB4Full;
+		}
+		// The length keeps rows from running into each other.
+		uint64_t tail = line.size() << 56;
+		memcpy(&tail, line.data() + i, line.size() - i);
+		low = Rotate(low ^ tail, 29) * 0x9FB21C651E98DF25ull;
+		high = Rotate(high + tail, 37) * 0xC2B2AE3D27D4EB4Full;
+	}
+	return { Mix(low ^ Rotate(high, 17)), Mix(high ^ low) };
+}
+
+MisbitFontAssembler::GlyphCache::GlyphCache() : loaded_count(0), hit_count(0), miss_count(0)
+{
+}
+
+void MisbitFontAssembler::GlyphCache::Load(const std::string &path)
+{
+	Entries.clear();
+	UsedEntries.clear();
+	loaded_count = 0;
+	hit_count = 0;
+	miss_count = 0;
+	std::ifstream input_file(path, std::ios::binary | std::ios::ate);
+	if (!input_file.is_open())
+	{
+		return;
+	}
+	std::vector<char> Data(static_cast<size_t>(input_file.tellg()));
+	input_file.seekg(0);
+	if (!input_file.read(Data.data(), Data.size()))
+	{
+		return;
+	}
+	if (Data.size() < sizeof(CacheMagic) || memcmp(Data.data(), CacheMagic, sizeof(CacheMagic)) != 0)
+	{
+		return;
+	}
+	size_t position = sizeof(CacheMagic);
+	uint32_t entry_count = 0;
+	if (!ReadValue(Data, position, entry_count))
+	{
+		return;
+	}
+	for (uint32_t i = 0; i < entry_count; ++i)
+	{
+		GlyphKey Key;
+		uint32_t size = 0;
+		if (!ReadValue(Data, position, Key.low) || !ReadValue(Data, position, Key.high) || !ReadValue(Data, position, size) || Data.size() - position < size)
+		{
+			Entries.clear();
+			return;
+		}
+		std::vector<uint8_t> &Packed = Entries[Key];
+		Packed.assign(Data.data() + position, Data.data() + position + size);
+		position += size;
+	}
+	loaded_count = Entries.size();
+}
+
+bool MisbitFontAssembler::GlyphCache::Save(const std::string &path)
+{
+	// Every character was found and none dropped out, so the file already holds exactly these entries.
+	if (miss_count == 0 && UsedEntries.size() == loaded_count)
+	{
+		return true;
+	}
+	std::string temporary_path = path + ".tmp";
+	{
+		std::ofstream output_file(temporary_path, std::ios::binary);
+		if (!output_file.is_open())
+		{
+			return false;
+		}
+		output_file.write(CacheMagic, sizeof(CacheMagic));
+		WriteValue(output_file, static_cast<uint32_t>(UsedEntries.size()));
+		for (const auto &[Key, Packed] : UsedEntries)
+		{
+			WriteValue(output_file, Key.low);
+			WriteValue(output_file, Key.high);
+			WriteValue(output_file, static_cast<uint32_t>(Packed.size()));
+			output_file.write(reinterpret_cast<const char *>(Packed.data()), Packed.size());
+		}
+		if (!output_file.good())
+		{
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary_path, path, error);
+	return !error;
+}
+
+// Starts the next assembly from the entries used by this one, as if they had been saved and loaded again.
+void MisbitFontAssembler::GlyphCache::Advance()
+{
+	Entries = std::move(UsedEntries);
+	UsedEntries.clear();
+	loaded_count = Entries.size();
+	hit_count = 0;
+	miss_count = 0;
+}
+
+const std::vector<uint8_t> *MisbitFontAssembler::GlyphCache::Find(const GlyphKey &Key) const
+{
+	auto Entry = Entries.find(Key);
+	return (Entry != Entries.end()) ? &Entry->second : nullptr;
+}
+
+void MisbitFontAssembler::GlyphCache::Keep(const GlyphKey &Key)
+{
+	++hit_count;
+	if (UsedEntries.find(Key) != UsedEntries.end())
+	{
+		return;
+	}
+	auto Entry = Entries.find(Key);
+	if (Entry != Entries.end())
+	{
+		UsedEntries.emplace(Key, std::move(Entry->second));
+	}
+}
+
+void MisbitFontAssembler::GlyphCache::Insert(const GlyphKey &Key, std::vector<uint8_t> &&Packed)
+{
+	++miss_count;
+	UsedEntries.emplace(Key, std::move(Packed));
+}
+
+size_t MisbitFontAssembler::GlyphCache::GetHitCount() const
+{
+	return hit_count;
+}
+
+size_t MisbitFontAssembler::GlyphCache::GetMissCount() const
+{
+	return miss_count;
+}
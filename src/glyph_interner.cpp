@@ -0,0 +1,77 @@
+#include "../include/glyph_interner.hpp"
+#include <string_view>
+#include <algorithm>
+
+MisbitFontAssembler::GlyphInterner::GlyphInterner()
+{
+}
+
+void MisbitFontAssembler::GlyphInterner::Intern(const FontData &Font)
+{
+	const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	uint32_t count = FontCharacterTable.GetCount();
+	size_t packed_size = (FontCharacterTable.GetCharacterBits() + 7) / 8;
+	std::vector<uint8_t> Packed(packed_size);
+	std::vector<uint8_t> OtherPacked(packed_size);
+	FirstIndices.clear();
+	CharacterFirstIndices.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		// The packed bytes are hashed as a single row, along with the width stored in the variable table.
+		FontCharacterTable.CopyPacked(i, Packed.data());
+		std::string_view row(reinterpret_cast<const char *>(Packed.data()), Packed.size());
+		uint16_t width = FontCharacterTable.GetWidth(i);
+		GlyphKey Key = HashCharacter(&row, 1, Font.Settings, DrawMode::Binary, width);
+		// Characters with the same hash are only merged when their bytes match too.
+		uint32_t first_index = i;
+		auto [Begin, End] = FirstIndices.equal_range(Key);
+		for (auto Entry = Begin; Entry != End; ++Entry)
+		{
+			FontCharacterTable.CopyPacked(Entry->second, OtherPacked.data());
+			if (FontCharacterTable.GetWidth(Entry->second) == width && OtherPacked == Packed)
+			{
+				first_index = Entry->second;
+				break;
+			}
+		}
+		if (first_index == i)
+		{
+			FirstIndices.emplace(Key, i);
+		}
+		CharacterFirstIndices[i] = first_index;
+	}
+}
+
+uint32_t MisbitFontAssembler::GlyphInterner::GetFirstIndex(uint32_t index) const
+{
+	return CharacterFirstIndices[index];
+}
+
+size_t MisbitFontAssembler::GlyphInterner::GetUniqueCount() const
+{
+	return FirstIndices.size();
+}
+
+// Every set of two or more identical characters, in order of their first index.
+std::vector<std::vector<uint32_t>> MisbitFontAssembler::GlyphInterner::GetDuplicateGroups() const
+{
+	std::vector<std::vector<uint32_t>> Groups;
+	std::vector<uint32_t> GroupIndices(CharacterFirstIndices.size(), 0);
+	for (uint32_t i = 0; i < CharacterFirstIndices.size(); ++i)
+	{
+		uint32_t first_index = CharacterFirstIndices[i];
+		if (first_index == i)
+		{
+			continue;
+		}
+		if (GroupIndices[first_index] == 0)
+		{
+			// Stored one higher so 0 can mean no group yet.
+			Groups.push_back({ first_index });
+			GroupIndices[first_index] = static_cast<uint32_t>(Groups.size());
+		}
+		Groups[GroupIndices[first_index] - 1].push_back(i);
+	}
+	std::sort(Groups.begin(), Groups.end(), [](const std::vector<uint32_t> &A, const std::vector<uint32_t> &B) { return A.front() < B.front(); });
+	return Groups;
+}
@@ -0,0 +1,22 @@
+#include "../include/include_cache.hpp"
+
+MisbitFontAssembler::IncludeCache::IncludeCache()
+{
+}
+
+std::shared_ptr<const MisbitFontAssembler::IncludedBlock> MisbitFontAssembler::IncludeCache::Find(const std::string &key, uint64_t file_size, int64_t file_time) const
+{
+	std::lock_guard<std::mutex> LockGuard(Lock);
+	auto Entry = Blocks.find(key);
+	if (Entry == Blocks.end() || Entry->second->file_size != file_size || Entry->second->file_time != file_time)
+	{
+		return nullptr;
+	}
+	return Entry->second;
+}
+
+void MisbitFontAssembler::IncludeCache::Insert(const std::string &key, std::shared_ptr<const IncludedBlock> Block)
+{
+	std::lock_guard<std::mutex> LockGuard(Lock);
+	Blocks[key] = std::move(Block);
+}
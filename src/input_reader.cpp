@@ -0,0 +1,171 @@
+#include "../include/input_reader.hpp"
+#include <cstring>
+#if __has_include(<sys/mman.h>)
+#define MISBITFONT_ASSEMBLER_USE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MisbitFontAssembler::InputReader::InputReader() : mapped_data(nullptr), mapped_size(0), position(0), file(nullptr), buffer_start(0), buffer_end(0), end_of_file(false), borrowed(false)
+{
+}
+
+MisbitFontAssembler::InputReader::~InputReader()
+{
+	Close();
+}
+
+bool MisbitFontAssembler::InputReader::Open(const std::string &path)
+{
+	Close();
+#ifdef MISBITFONT_ASSEMBLER_USE_MMAP
+	// '-' reads standard input, which is still mapped when it is redirected from the start of a file.
+	bool standard_input = (path == "-");
+	int fd = standard_input ? dup(STDIN_FILENO) : open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	if ((!standard_input || lseek(fd, 0, SEEK_CUR) == 0) && File.Map(fd))
+	{
+		::close(fd);
+		mapped_data = reinterpret_cast<const char *>(File.GetData());
+		mapped_size = File.GetSize();
+		return true;
+	}
+	file = fdopen(fd, "rb");
+	if (file == nullptr)
+	{
+		::close(fd);
+		return false;
+	}
+#else
+	if (path == "-")
+	{
+		file = stdin;
+		borrowed = true;
+	}
+	else
+	{
+		file = std::fopen(path.c_str(), "rb");
+	}
+	if (file == nullptr)
+	{
+		return false;
+	}
+#endif
+	buffer.resize(ReadSize);
+	return true;
+}
+
+void MisbitFontAssembler::InputReader::OpenBuffer(std::string_view data)
+{
+	Close();
+	mapped_data = data.empty() ? "" : data.data();
+	mapped_size = data.size();
+	borrowed = true;
+}
+
+void MisbitFontAssembler::InputReader::Close()
+{
+	File.Close();
+	if (file != nullptr && !borrowed)
+	{
+		std::fclose(file);
+	}
+	mapped_data = nullptr;
+	mapped_size = 0;
+	position = 0;
+	file = nullptr;
+	buffer_start = 0;
+	buffer_end = 0;
+	end_of_file = false;
+	borrowed = false;
+}
+
+bool MisbitFontAssembler::InputReader::NextLine(std::string_view &line)
+{
+	const char *data = nullptr;
+	size_t length = 0;
+	if (mapped_data != nullptr)
+	{
+		if (position >= mapped_size)
+		{
+			return false;
+		}
+		data = mapped_data + position;
+		const char *newline = static_cast<const char *>(memchr(data, '\n', mapped_size - position));
+		length = (newline != nullptr) ? static_cast<size_t>(newline - data) : mapped_size - position;
+		position += length + 1;
+	}
+	else if (file != nullptr)
+	{
+		size_t scan_start = buffer_start;
+		const char *newline = nullptr;
+		while ((newline = static_cast<const char *>(memchr(buffer.data() + scan_start, '\n', buffer_end - scan_start))) == nullptr)
+		{
+			scan_start = buffer_end - buffer_start;
+			if (!Refill())
+			{
+				break;
+			}
+		}
+		if (newline == nullptr && buffer_start == buffer_end)
+		{
+			return false;
+		}
+		data = buffer.data() + buffer_start;
+		length = (newline != nullptr) ? static_cast<size_t>(newline - data) : buffer_end - buffer_start;
+		buffer_start += (newline != nullptr) ? length + 1 : length;
+	}
+	else
+	{
+		return false;
+	}
+	if (length > 0 && data[length - 1] == '\r')
+	{
+		--length;
+	}
+	line = std::string_view(data, length);
+	return true;
+}
+
+// Starts over from the first line.  Only possible when IsMapped().
+bool MisbitFontAssembler::InputReader::Rewind()
+{
+	position = 0;
+	return mapped_data != nullptr;
+}
+
+bool MisbitFontAssembler::InputReader::IsMapped() const
+{
+	return mapped_data != nullptr;
+}
+
+bool MisbitFontAssembler::InputReader::Refill()
+{
+	if (end_of_file)
+	{
+		return false;
+	}
+	// Keep the partial line, moving it to the front (or growing the buffer when the line fills it).
+	size_t pending = buffer_end - buffer_start;
+	if (buffer_start > 0)
+	{
+		memmove(buffer.data(), buffer.data() + buffer_start, pending);
+		buffer_start = 0;
+		buffer_end = pending;
+	}
+	if (buffer.size() - buffer_end < ReadSize / 2)
+	{
+		buffer.resize(buffer.size() * 2);
+	}
+	size_t bytes_read = std::fread(buffer.data() + buffer_end, 1, buffer.size() - buffer_end, file);
+	if (bytes_read == 0)
+	{
+		end_of_file = true;
+		return false;
+	}
+	buffer_end += bytes_read;
+	return true;
+}
@@ -0,0 +1,58 @@
+#include "../include/lexer.hpp"
+
+namespace
+{
+	constexpr bool IsSeparator(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == '\0';
+	}
+}
+
+MisbitFontAssembler::Lexer::Lexer() : position(0)
+{
+}
+
+void MisbitFontAssembler::Lexer::Reset(std::string_view line)
+{
+	this->line = line;
+	position = 0;
+}
+
+bool MisbitFontAssembler::Lexer::Next(Lexeme &lexeme)
+{
+	while (position < line.size() && IsSeparator(line[position]))
+	{
+		++position;
+	}
+	if (position >= line.size() || line[position] == ';')
+	{
+		position = line.size();
+		return false;
+	}
+	lexeme.column = position;
+	if (line[position] == '"')
+	{
+		size_t end = line.find('"', position + 1);
+		if (end == std::string_view::npos)
+		{
+			lexeme.type = LexemeType::UnterminatedString;
+			lexeme.text = line.substr(position + 1);
+			position = line.size();
+		}
+		else
+		{
+			lexeme.type = LexemeType::String;
+			lexeme.text = line.substr(position + 1, end - position - 1);
+			position = end + 1;
+		}
+		return true;
+	}
+	size_t start = position;
+	while (position < line.size() && !IsSeparator(line[position]) && line[position] != ';' && line[position] != '"')
+	{
+		++position;
+	}
+	lexeme.type = LexemeType::Word;
+	lexeme.text = line.substr(start, position - start);
+	return true;
+}
@@ -1,18 +1,39 @@
 #include "../include/application.hpp"
-#include <cstring>
-#include <fstream>
-#include <sstream>
-#include <regex>
-#include <msbtfont/msbtfont.h>
+#include "../include/input_reader.hpp"
+#include "../include/assembler.hpp"
+#include "../include/emitter.hpp"
+#include "../include/diagnostics.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/number_parser.hpp"
+#include "../include/statistics.hpp"
+#include "../include/allocation_counter.hpp"
+#include "../include/glyph_cache.hpp"
+#include "../include/glyph_interner.hpp"
+#include "../include/file_watcher.hpp"
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include <chrono>
 #include <fmt/core.h>
 
-MisbitFontAssembler::Application::Application(std::vector<std::string> &&Args) : current_line_number(1), error_count(0), warning_count(0), Args(Args), current_draw_mode(MisbitFontAssembler::DrawMode::Binary), palette_format(1), current_max_font_size { 1, 1 }, current_draw_coordinates { 0, 0 }, current_font_width(0), font_name(""), language(""), current_spacing_type(SpacingType::Monospace), draw(false), exit(false), retcode(0)
+MisbitFontAssembler::Application::Application(std::vector<std::string> &&Args) : Args(Args), output_format(OutputFormat::MisbitFont), console(stdout), thread_count(1), decode_thread_count(1), batch(false), stream(false), stats(false), watch(false), dedupe_report(false), from_bdf(false), exit(false), retcode(0)
 {
-	fmt::print("MisbitFont Assembler V{}.{}\n", Version.major, Version.minor);
-	fmt::print("By Joshua Moss\n\n");
+	// With '-o -' the font itself goes to standard output, so everything else is printed to standard error.
+	if (std::adjacent_find(Args.begin(), Args.end(), [](const std::string &Option, const std::string &Value) { return Option == "-o" && Value == "-"; }) != Args.end())
+	{
+		console = stderr;
+	}
+	// Keeps JSON output parseable from the first line.
+	if (std::find(Args.begin(), Args.end(), "--diagnostics=json") == Args.end())
+	{
+		fmt::print(console, "MisbitFont Assembler V{}.{}\n", Version.major, Version.minor);
+		fmt::print(console, "By Joshua Moss\n\n");
+	}
 	if (Args.size() == 0)
 	{
-		fmt::print("Format:  misbitfont_assembler [input] -o [output]\n");
+		PrintFormat();
 		exit = true;
 	}
 }
@@ -23,1832 +44,471 @@ MisbitFontAssembler::Application::~Application()
 
 void MisbitFontAssembler::Application::Assemble()
 {
-	std::ifstream input_file(Args[0]);
-	if (!input_file.is_open())
+	if (!ParseArguments())
 	{
-		fmt::print("Unable to open '{}'.\n", Args[0]);
 		exit = true;
 		retcode = -1;
 		return;
 	}
-	bool output_switch = false;
-	std::ofstream output_file;
-	for (auto &i : Args)
+	if (watch)
+	{
+		Watch();
+		return;
+	}
+	if (!batch)
 	{
-		if (output_switch)
+		Assembler JobAssembler;
+		Diagnostics JobDiagnostics(JobDiagnosticsOptions, Jobs[0].input_path);
+		bool success = AssembleFile(Jobs[0], JobAssembler, JobDiagnostics);
+		JobDiagnostics.Summarize(success);
+		if (!success)
 		{
-			if (i == Args[0])
-			{
-				fmt::print("Do not specify the output file as the input file.\n");
-				exit = true;
-				retcode = -1;
-				return;
-			}
-			output_file.open(i, std::ios::binary);
-			fmt::print("Attempting to assemble {} to {}...\n", Args[0], i);
-			break;
+			retcode = -1;
+		}
+		JobDiagnostics.Flush(console);
+		return;
+	}
+	std::mutex OutputLock;
+	std::atomic<size_t> failure_count = 0;
+	{
+		ThreadPool Pool(thread_count, Jobs.size());
+		if (!Pool.HasStarted())
+		{
+			fmt::print(console, "Unable to start the threads to assemble on.\n");
+			retcode = -1;
+			return;
+		}
+		if (JobDiagnosticsOptions.format == DiagnosticsFormat::Text)
+		{
+			fmt::print(console, "Assembling {} file{} using {} thread{}...\n\n", Jobs.size(), (Jobs.size() != 1) ? "s" : "", Pool.GetThreadCount(), (Pool.GetThreadCount() != 1) ? "s" : "");
 		}
-		if (i == "-o")
+		for (const auto &Job : Jobs)
 		{
-			output_switch = true;
+			Pool.Submit([this, &Job, &OutputLock, &failure_count]()
+			{
+				Assembler JobAssembler;
+				Diagnostics JobDiagnostics(JobDiagnosticsOptions, Job.input_path);
+				bool success = AssembleFile(Job, JobAssembler, JobDiagnostics);
+				JobDiagnostics.Summarize(success);
+				if (!success)
+				{
+					++failure_count;
+				}
+				JobDiagnostics.Message("");
+				std::lock_guard<std::mutex> OutputGuard(OutputLock);
+				JobDiagnostics.Flush(console);
+			});
 		}
+		Pool.Wait();
 	}
-	if (!output_switch)
+	size_t success_count = Jobs.size() - failure_count;
+	if (JobDiagnosticsOptions.format == DiagnosticsFormat::Text)
+	{
+		fmt::print(console, "{} of {} file{} assembled successfully.\n", success_count, Jobs.size(), (Jobs.size() != 1) ? "s" : "");
+	}
+	if (failure_count > 0)
 	{
-		fmt::print("You need to specify an output file.\n");
-		exit = true;
+		retcode = -1;
+	}
+}
+
+// Reassembles the input every time it is saved, until watching fails or the process is interrupted.
+void MisbitFontAssembler::Application::Watch()
+{
+	const AssemblyJob &Job = Jobs[0];
+	FileWatcher InputWatcher;
+	if (!InputWatcher.Open(Job.input_path))
+	{
+		fmt::print(console, "Unable to watch '{}'.\n", Job.input_path);
 		retcode = -1;
 		return;
 	}
-	msbtfont_header header;
-	msbtfont_header_descriptor header_descriptor;
-	memset(&header_descriptor, 0, sizeof(msbtfont_header_descriptor));
-	while (!input_file.fail())
+	if (!cache_directory.empty())
+	{
+		WatchCache.Load(GetCachePath(Job.input_path));
+	}
+	// Reused for every rebuild, so its buffers are only allocated once.
+	Assembler JobAssembler;
+	do
+	{
+		auto start_time = std::chrono::steady_clock::now();
+		Diagnostics JobDiagnostics(JobDiagnosticsOptions, Job.input_path);
+		bool success = AssembleFile(Job, JobAssembler, JobDiagnostics);
+		JobDiagnostics.Summarize(success);
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+		JobDiagnostics.Message(fmt::format("Finished in {:.1f} ms.  Watching '{}' for changes...", milliseconds, Job.input_path));
+		JobDiagnostics.Message("");
+		JobDiagnostics.Flush(console);
+	} while (InputWatcher.Wait());
+	fmt::print(console, "Unable to watch '{}'.\n", Job.input_path);
+	retcode = -1;
+}
+
+bool MisbitFontAssembler::Application::GetExit() const
+{
+	return exit;
+}
+
+int MisbitFontAssembler::Application::GetReturnCode() const
+{
+	return retcode;
+}
+
+void MisbitFontAssembler::Application::PrintFormat() const
+{
+	fmt::print(console, "Format:  misbitfont_assembler [options] [input] -o [output]     ('-' for standard input or output)\n");
+	fmt::print(console, "         misbitfont_assembler [options] [-j threads] [input]:[output] ...\n");
+	fmt::print(console, "         misbitfont_assembler [options] [-j threads] --out-dir [directory] [input] ...\n");
+	fmt::print(console, "Options: --stream, --watch, --stats, --dedupe-report, --from-bdf, --emit=[msbtfont|cxx-header], --decode-threads [threads], --cache [directory], --max-warnings [count], --diagnostics=[text|json]\n");
+}
+
+bool MisbitFontAssembler::Application::ParseArguments()
+{
+	std::vector<std::string> Inputs;
+	std::string output_path;
+	std::string output_directory;
+	for (size_t i = 0; i < Args.size(); ++i)
 	{
-		std::array<char, 4096> line_data;
-		std::string token = "";
-		std::string u_token = "";
-		bool error = false;
-		bool comment = false;
-		bool string_mode = false;
-		bool draw_pixel = false;
-		ErrorType error_type = ErrorType::NoError;
-		TokenType token_type = TokenType::None;
-		input_file.getline(line_data.data(), line_data.size(), '\n');
-		size_t characters_read = input_file.gcount();
-		auto ProcessUInt8 = [&token, &error, &error_type](bool hex_support, bool bin_support)
+		if (Args[i] == "--stream")
 		{
-			std::regex hex("0xa-fA-F0-9]{1,}");
-			std::regex bin("0b[0-1]{1,8}");
-			std::regex dec("[0-9]{1,}");
-			std::smatch match;
-			uint16_t value = 0;
-			if (hex_support && std::regex_search(token, match, hex))
-			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
-				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint8_t>(0);
-				}
-				std::istringstream hex_str(match.str());
-				hex_str >> std::hex >> value;
-			}
-			else if (bin_support && std::regex_search(token, match, bin))
-			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
-				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint8_t>(0);
-				}
-				for (size_t c = 0; c < match.str().size() - 2; ++c)
-				{
-					if (match.str()[2 + c] == '1')
-					{
-						value |= (0x80 >> (7 - ((match.str().size() - 3) - c)));
-					}
-				}
-			}
-			else if (std::regex_search(token, match, dec))
-			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
-				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint8_t>(0);
-				}
-				std::istringstream dec_str(match.str());
-				dec_str >> value;
-			}
-			else
-			{
-				error = true;
-				error_type = ErrorType::InvalidValue;
-				return static_cast<uint8_t>(0);
-			}
-			return static_cast<uint8_t>(value & 0xFF);
-		};
-		auto ProcessUInt16 = [&token, &error, &error_type](bool hex_support, bool bin_support)
+			stream = true;
+		}
+		else if (Args[i] == "--watch")
+		{
+			watch = true;
+		}
+		else if (Args[i] == "--stats")
+		{
+			stats = true;
+		}
+		else if (Args[i] == "--dedupe-report")
+		{
+			dedupe_report = true;
+		}
+		else if (Args[i] == "--from-bdf")
+		{
+			from_bdf = true;
+		}
+		else if (Args[i] == "--diagnostics=text" || Args[i] == "--diagnostics=json")
+		{
+			JobDiagnosticsOptions.format = (Args[i] == "--diagnostics=json") ? DiagnosticsFormat::Json : DiagnosticsFormat::Text;
+		}
+		else if (Args[i] == "--emit=msbtfont" || Args[i] == "--emit=cxx-header")
+		{
+			output_format = (Args[i] == "--emit=cxx-header") ? OutputFormat::CxxHeader : OutputFormat::MisbitFont;
+		}
+		else if (Args[i] == "-o" || Args[i] == "-j" || Args[i] == "--out-dir" || Args[i] == "--max-warnings" || Args[i] == "--decode-threads" || Args[i] == "--cache")
 		{
-			std::regex hex("0x[a-fA-F0-9]{1,}");
-			std::regex bin("0b[0-1]{1,16}");
-			std::regex dec("[0-9]{1,}");
-			std::smatch match;
-			uint16_t value = 0;
-			if (hex_support && std::regex_search(token, match, hex))
+			if (i + 1 >= Args.size())
 			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
-				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint16_t>(0);
-				}
-				std::istringstream hex_str(match.str());
-				hex_str >> std::hex >> value;
+				fmt::print(console, "Missing value for '{}'.\n", Args[i]);
+				return false;
 			}
-			else if (bin_support && std::regex_search(token, match, bin))
+			const std::string &value = Args[++i];
+			if (Args[i - 1] == "-o")
 			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
-				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint16_t>(0);
-				}
-				for (size_t c = 0; c < match.str().size() - 2; ++c)
-				{
-					if (match.str()[2 + c] == '1')
-					{
-						value |= (0x8000 >> (15 - ((match.str().size() - 3) - c)));
-					}
-				}
+				output_path = value;
 			}
-			else if (std::regex_search(token, match, dec))
+			else if (Args[i - 1] == "--decode-threads")
 			{
-				if (match.prefix().str().size() > 0 || match.suffix().str().size() > 0)
+				if (!ParseNumber(value, NumberFormat::Decimal, decode_thread_count))
 				{
-					error = true;
-					error_type = ErrorType::InvalidValue;
-					return static_cast<uint16_t>(0);
+					fmt::print(console, "Invalid thread count '{}'.\n", value);
+					return false;
 				}
-				std::istringstream dec_str(match.str());
-				dec_str >> value;
 			}
-			else
+			else if (Args[i - 1] == "--cache")
 			{
-				error = true;
-				error_type = ErrorType::InvalidValue;
+				cache_directory = value;
 			}
-			return value;
-		};
-		auto ProcessFontSize = [this, &token, &error, &error_type]()
-		{
-			FontSizeData size = { 0, 0 };
-			std::string current_value = "";
-			bool set_height = false;
-			for (size_t c = 0; c < token.size(); ++c)
+			else if (Args[i - 1] == "--max-warnings")
 			{
-				if (token[c] == 'x')
+				if (!ParseNumber(value, NumberFormat::Decimal, JobDiagnosticsOptions.max_warnings))
 				{
-					if(!set_height)
-					{
-						set_height = true;
-						current_value += ' ';
-						continue;
-					}
-					else
-					{
-						error = true;
-						error_type = ErrorType::InvalidValue;
-						return size;
-					}
+					fmt::print(console, "Invalid warning limit '{}'.\n", value);
+					return false;
 				}
-				current_value += token[c];
 			}
-			std::istringstream sizestr(current_value);
-			sizestr >> size.width >> size.height;
-			return size;
-		};
-		for (size_t i = 0; i < characters_read; ++i)
-		{
-			auto IssueWarning = [this, &token, &i](std::string message)
-			{
-				++warning_count;
-				fmt::print("Warning at {}:{} : {}\n", current_line_number, i - token.size(), message);
-			};
-			auto DrawPixel = [this, &token, &IssueWarning](unsigned char pixel)
+			else if (Args[i - 1] == "--out-dir")
 			{
-				if (current_draw_coordinates.y < current_max_font_size.height)
-				{
-					uint16_t character_font_width = (current_spacing_type == SpacingType::Variable) ? CurrentFontCharacter.width : current_max_font_size.width;
-					if (!character_font_width)
-					{
-						character_font_width = current_max_font_size.width;
-					}
-					if (current_draw_coordinates.x < character_font_width)
-					{
-						size_t c_offset = (((current_draw_coordinates.y * current_max_font_size.width) + current_draw_coordinates.x) * palette_format) / 8;
-						uint8_t bit_offset = (((current_draw_coordinates.y * current_max_font_size.width) + current_draw_coordinates.x) * palette_format) % 8;
-						if (palette_format < 8)
-						{
-							pixel <<= (8 - palette_format);
-						}
-						CurrentFontCharacter.character[c_offset] |= (pixel >> bit_offset);
-						uint8_t bit_offset_s = bit_offset;
-						size_t bits_left = palette_format;
-						bit_offset += bits_left;
-						if (bit_offset > 7)
-						{
-							bits_left -= (bit_offset - bit_offset_s);
-							bit_offset -= 8;
-							++c_offset;
-							if (bits_left > 0)
-							{
-								CurrentFontCharacter.character[c_offset] |= ((pixel >> (8 - bits_left)) << (8 - palette_format));
-							}
-						}
-						++current_draw_coordinates.x;
-					}
-					else
-					{
-						IssueWarning("Drawing out of bounds on the x-axis.  Skipping pixel.");
-					}
-				}
-				else
-				{
-					IssueWarning("Drawing out of bounds on the y-axis.  Skipping pixel.");
-				}
-				token = "";
-			};
-			if (!draw)
-			{
-				switch (line_data[i])
-				{
-					case ';':
-					{
-						if (!string_mode)
-						{
-							if (!comment)
-							{
-								comment = true;
-							}
-						}
-						else
-						{
-							token += line_data[i];
-						}
-						break;
-					}
-					case '"':
-					{
-						if (!comment)
-						{
-							if (!string_mode)
-							{
-								switch (token_type)
-								{
-									case TokenType::FontName:
-									case TokenType::Language:
-									{
-										string_mode = true;
-										break;
-									}
-								}
-							}
-							else
-							{
-								size_t token_len = token.size();
-								switch (token_type)
-								{
-									case TokenType::FontName:
-									{
-										if (token_len > 64)
-										{
-											IssueWarning("Font Name specified takes up more than 64 bytes.  Upon assembly, it will be truncated.");
-										}
-										font_name = std::move(token);
-										string_mode = false;
-										break;
-									}
-									case TokenType::Language:
-									{
-										if (token_len > 64)
-										{
-											IssueWarning("Language specified takes up more than 64 bytes.  Upon assembly, it will be truncated.");
-										}
-										language = std::move(token);
-										string_mode = false;
-										break;
-									}
-								}
-							}
-						}
-						break;
-					}
-					case ' ':
-					{
-						if (!string_mode)
-						{
-							if (token.size() > 0 && !comment)
-							{
-								if (token_type == TokenType::None)
-								{
-									bool valid_token = false;
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										u_token += toupper(static_cast<unsigned char>(token[c]));
-									}
-									for (auto t : TokenList)
-									{
-										if (u_token == t)
-										{
-											valid_token = true;
-											if (t == "CURRENT_FONT_WIDTH")
-											{
-												token_type = TokenType::CurrentFontWidth;
-											}
-											else if (t == "DRAW")
-											{
-												token_type = TokenType::Draw;
-											}
-											else if (t == "DRAW_MODE")
-											{
-												token_type = TokenType::DrawMode;
-											}
-											else if (t == "FONT_NAME")
-											{
-												token_type = TokenType::FontName;
-											}
-											else if (t == "LANGUAGE")
-											{
-												token_type = TokenType::Language;
-											}
-											else if (t == "MAX_FONT_SIZE")
-											{
-												token_type = TokenType::MaxFontSize;
-											}
-											else if (t == "PALETTE_FORMAT")
-											{
-												token_type = TokenType::PaletteFormat;
-											}
-											else if (t == "SPACING_TYPE")
-											{
-												token_type = TokenType::SpacingType;
-											}
-											token = "";
-											u_token = "";
-											break;
-										}
-									}
-									if (!valid_token)
-									{
-										error = true;
-										error_type = ErrorType::InvalidToken;
-									}
-									break;
-								}
-							}
-						}
-						else
-						{
-							token += line_data[i];
-						}
-						break;
-					}
-					case '\0':
-					{
-						if (token.size() > 0)
-						{
-							bool valid_token = false;
-							for (size_t c = 0; c < token.size(); ++c)
-							{
-								u_token += toupper(static_cast<unsigned char>(token[c]));
-							}
-							switch (token_type)
-							{
-								case TokenType::None:
-								{
-									for (auto t : TokenList)
-									{
-										if (u_token == t)
-										{
-											valid_token = true;
-											if (t == "CURRENT_FONT_WIDTH")
-											{
-												token_type = TokenType::CurrentFontWidth;
-											}
-											else if (t == "DRAW")
-											{
-												token_type = TokenType::Draw;
-											}
-											else if (t == "DRAW_MODE")
-											{
-												token_type = TokenType::DrawMode;
-											}
-											else if (t == "FONT_NAME")
-											{
-												token_type = TokenType::FontName;
-											}
-											else if (t == "LANGUAGE")
-											{
-												token_type = TokenType::Language;
-											}
-											else if (t == "MAX_FONT_SIZE")
-											{
-												token_type = TokenType::MaxFontSize;
-											}
-											else if (t == "PALETTE_FORMAT")
-											{
-												token_type = TokenType::PaletteFormat;
-											}
-											else if (t == "SPACING_TYPE")
-											{
-												token_type = TokenType::SpacingType;
-											}
-											error = true;
-											error_type = ErrorType::MissingOperand;
-											break;
-										}
-									}
-									if (!valid_token)
-									{
-										error = true;
-										error_type = ErrorType::InvalidToken;
-									}
-									break;
-								}
-								case TokenType::CurrentFontWidth:
-								{
-									uint16_t current_font_width = ProcessUInt16(true, false);
-									if (error)
-									{
-										break;
-									}
-									if (current_spacing_type == SpacingType::Variable)
-									{
-										if (current_font_width > current_max_font_size.width)
-										{
-											IssueWarning("Current font width must not be greater than the max font width.  This statement has no effect.");
-										}
-										else
-										{
-											this->current_font_width = current_font_width;
-										}
-									}
-									else
-									{
-										IssueWarning("Setting the current font width is unsupported in 'monospace' mode.  No changes were made as a result.");
-									}
-									break;
-								}
-								case TokenType::Draw:
-								{
-									bool valid_token = false;
-									for (auto t : ToggleList)
-									{
-										if (u_token == t)
-										{
-											valid_token = true;
-											if (t == "OFF")
-											{
-												IssueWarning("Drawing is already off.  This statement has no effect.");
-											}
-											else if (t == "ON")
-											{
-												draw = true;
-												size_t font_character_data_size = current_max_font_size.width * current_max_font_size.height * (palette_format + 1) / 8;
-												if ((current_max_font_size.width * current_max_font_size.height * (palette_format + 1)) % 8 != 0)
-												{
-													++font_character_data_size;
-												}
-												CurrentFontCharacter.character.resize(font_character_data_size);
-												if (current_spacing_type == SpacingType::Variable)
-												{
-													CurrentFontCharacter.width = current_font_width;
-												}
-											}
-											break;
-										}
-									}
-									if (!valid_token)
-									{
-										error = true;
-										error_type = ErrorType::InvalidToken;
-									}
-									break;
-								}
-								case TokenType::DrawMode:
-								{
-									bool valid_token = false;
-									for (auto d : DrawModeList)
-									{
-										if (u_token == d)
-										{
-											valid_token = true;
-											if (d == "BINARY")
-											{
-												current_draw_mode = DrawMode::Binary;
-											}
-											else if (d == "OCTAL")
-											{
-												current_draw_mode = DrawMode::Octal;
-											}
-											else if (d == "DECIMAL")
-											{
-												current_draw_mode = DrawMode::Decimal;
-											}
-											else if (d == "HEXADECIMAL")
-											{
-												current_draw_mode = DrawMode::Hexadecimal;
-											}
-											break;
-										}
-									}
-									if (!valid_token)
-									{
-										error = true;
-										error_type = ErrorType::InvalidToken;
-									}
-									break;
-								}
-								case TokenType::FontName:
-								{
-									break;
-								}
-								case TokenType::Language:
-								{
-									break;
-								}
-								case TokenType::MaxFontSize:
-								{
-									FontSizeData size = ProcessFontSize();
-									if (error)
-									{
-										break;
-									}
-									if ((size.width >= 1 && size.width <= 256) && (size.height >= 1 && size.height <= 256))
-									{
-										current_max_font_size = size;
-									}
-									else
-									{
-										error = true;
-										error_type = ErrorType::UnsupportedMaxFontSize;
-									}
-									break;
-								}
-								case TokenType::PaletteFormat:
-								{
-									uint8_t palette_format = ProcessUInt8(false, false);
-									if (error)
-									{
-										break;
-									}
-									if (FontCharacterTable.size() == 0)
-									{
-										if (palette_format >= 1 && palette_format <= 8)
-										{
-											fmt::print("Setting Palette Format to {}.\n", palette_format);
-											this->palette_format = palette_format;
-										}
-										else
-										{
-											error = true;
-											error_type = ErrorType::UnsupportedPaletteFormat;
-										}
-									}
-									else
-									{
-										IssueWarning("You can only specify the palette format if nothing has been drawn.  This statement has no effect.");
-									}
-									break;
-								}
-								case TokenType::SpacingType:
-								{
-									if (FontCharacterTable.size() == 0)
-									{
-										bool valid_token = false;
-										for (auto s : SpacingTypeList)
-										{
-											if (u_token == s)
-											{
-												valid_token = true;
-												if (s == "MONOSPACE")
-												{
-													current_spacing_type = SpacingType::Monospace;
-												}
-												else if (s == "VARIABLE")
-												{
-													current_spacing_type = SpacingType::Variable;
-												}
-												break;
-											}
-										}
-										if (!valid_token)
-										{
-											error = true;
-											error_type = ErrorType::InvalidToken;
-										}
-									}
-									else
-									{
-										IssueWarning("You can only specify the spacing type format if nothing has been drawn.  This statement has no effect.");
-									}
-									break;
-								}
-							}
-						}
-						break;
-					}
-					default:
-					{
-						if (!comment)
-						{
-							if (token.size() == 0)
-							{
-								switch (token_type)
-								{
-									case TokenType::CurrentFontWidth:
-									case TokenType::PaletteFormat:
-									case TokenType::MaxFontSize:
-									{
-										if (!isdigit(static_cast<unsigned char>(line_data[i])))
-										{
-											error = true;
-											break;
-										}
-										else if (isspace(static_cast<unsigned char>(line_data[i])))
-										{
-											break;
-										}
-										token += line_data[i];
-										break;
-									}
-									case TokenType::FontName:
-									case TokenType::Language:
-									{
-										if (!string_mode)
-										{
-											error = true;
-											error_type = ErrorType::StringRequirement;
-											break;
-										}
-										token += line_data[i];
-										break;
-									}
-									default:
-									{
-										if (isdigit(static_cast<unsigned char>(line_data[i])))
-										{
-											error = true;
-											break;
-										}
-										else if (isspace(static_cast<unsigned char>(line_data[i])))
-										{
-											break;
-										}
-										token += line_data[i];
-										break;
-									}
-								}
-							}
-							else
-							{
-								token += line_data[i];
-							}
-						}
-						break;
-					}
-				}
+				output_directory = value;
+				batch = true;
 			}
 			else
 			{
-				auto ProcessPixel = [this, &token, &IssueWarning]()
-				{
-					uint8_t pixel = 0;
-					switch (current_draw_mode)
-					{
-						case DrawMode::Binary:
-						{
-							for (size_t c = 0; c < token.size(); ++c)
-							{
-								if (token[c] == '1')
-								{
-									pixel |= (0x01 << ((token.size() - 1) - c));
-								}
-								else if (token[c] != '0')
-								{
-									pixel = 0;
-									IssueWarning("Unsupported value (must be 0s or 1s in binary drawing mode).  This pixel will be zeroed.");
-									break;
-								}
-							}
-							break;
-						}
-						case DrawMode::Octal:
-						{
-							uint8_t max_value = (0xFF >> (8 - palette_format));
-							switch (palette_format)
-							{
-								case 1:
-								case 2:
-								{
-									if (token[0] >= '0' && token[0] <= '7')
-									{
-										pixel = static_cast<uint8_t>(token[0] - '0');
-										if (pixel > max_value)
-										{
-											pixel &= (0xFF >> (8 - palette_format));
-											IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-										}
-									}
-									else
-									{
-										pixel = 0;
-										IssueWarning("Unsupported value (must be 0-7s in octal drawing).  This pixel will be zeroed.");
-									}
-									break;
-								}
-								case 3:
-								{
-									if (token[0] >= '0' && token[0] <= '7')
-									{
-										pixel = static_cast<uint8_t>(token[0] - '0');
-									}
-									else
-									{
-										pixel = 0;
-										IssueWarning("Unsupported value (must be 0-7s in octal drawing).  This pixel will be zeroed.");
-									}
-									break;
-								}
-								case 4:
-								case 5:
-								{
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										if (token[c] >= '0' && token[c] <= '7')
-										{
-											pixel |= (static_cast<uint8_t>(token[c] - '0') << (3 * ((token.size() - 1) - c)));
-										}
-										else
-										{
-											pixel = 0;
-											IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-											break;
-										}
-									}
-									if (pixel > max_value)
-									{
-										pixel &= (0xFF >> (8 - palette_format));
-										IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-									}
-									break;
-								}
-								case 6:
-								{
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										if (token[c] >= '0' && token[c] <= '7')
-										{
-											pixel |= (static_cast<uint8_t>(token[c] - '0') << (3 * ((token.size() - 1) - c)));
-										}
-										else
-										{
-											pixel = 0;
-											IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-										}
-									}
-									break;
-								}
-								case 7:
-								case 8:
-								{
-									bool overflow = false;
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										if (token[c] >= '0' && token[c] <= '7')
-										{
-											uint8_t digit = static_cast<uint8_t>(token[c] - '0');
-											if (c == 0 && digit > 3 && token.size() == 3)
-											{
-												overflow = true;
-											}
-											pixel |= static_cast<uint8_t>(digit << (3 * ((token.size() - 1) - c)));
-										}
-										else
-										{
-											pixel = 0;
-											if (overflow)
-											{
-												overflow = false;
-											}
-											IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-											break;
-										}
-									}
-									if (pixel > max_value)
-									{
-										if (!overflow)
-										{
-											overflow = true;
-										}
-										pixel &= (0xFF >> (8 - palette_format));
-									}
-									if (overflow)
-									{
-										IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-									}
-									break;
-								}
-							}
-							break;
-						}
-						case DrawMode::Decimal:
-						{
-							uint8_t max_value = (0xFF >> (8 - palette_format));
-							switch (palette_format)
-							{
-								case 1:
-								case 2:
-								case 3:
-								{
-									if (token[0] >= '0' && token[0] <= '9')
-									{
-										pixel = static_cast<uint8_t>(token[0] - '0');
-										if (pixel > max_value)
-										{
-											pixel &= (0xFF >> (8 - palette_format));
-											IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-										}
-									}
-									else
-									{
-										pixel = 0;
-										IssueWarning("Unsupported value (must be 0-9s in decimal drawing).  This pixel will be zeroed.");
-									}
-									break;
-								}
-								case 4:
-								case 5:
-								case 6:
-								{
-									uint8_t digit = 1;
-									for (size_t c = 1; c < token.size(); ++c)
-									{
-										digit *= 10;
-									}
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										if (token[c] >= '0' && token[c] <= '9')
-										{
-											pixel += (static_cast<uint8_t>(token[c] - '0') * digit);
-											digit /= 10;
-										}
-										else
-										{
-											pixel = 0;
-											IssueWarning("Unsupported value (must be 0-9s in decimal drawing mode).  This pixel will be zeroed.");
-											break;
-										}
-									}
-									if (pixel > max_value)
-									{
-										pixel &= (0xFF >> (8 - palette_format));
-										IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-									}
-									break;
-								}
-								case 7:
-								case 8:
-								{
-									bool overflow = false;
-									uint8_t digit = 1;
-									for (size_t c = 1; c < token.size(); ++c)
-									{
-										digit *= 10;
-									}
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										if (token[c] >= '0' && token[c] <= '9')
-										{
-											uint8_t tmp = pixel;
-											pixel += (static_cast<uint8_t>(token[c] - '0') * digit);
-											digit /= 10;
-											if (tmp > pixel && !overflow)
-											{
-												overflow = true;
-											}
-										}
-										else
-										{
-											pixel = 0;
-											if (overflow)
-											{
-												overflow = false;
-											}
-											IssueWarning("Unsupported value (must be 0-9s in decimal drawing mode).  This pixel will be zeroed.");
-											break;
-										}
-									}
-									if (pixel > max_value)
-									{
-										if (!overflow)
-										{
-											overflow = true;
-										}
-										pixel &= (0xFF >> (8 - palette_format));
-									}
-									if (overflow)
-									{
-										IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-									}
-									break;
-								}
-							}
-							break;
-						}
-						case DrawMode::Hexadecimal:
-						{
-							uint8_t max_value = (0xFF >> (8 - palette_format));
-							switch (palette_format)
-							{
-								case 1:
-								case 2:
-								case 3:
-								{
-									uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[0])));
-									if (current_char >= '0' && current_char <= '9')
-									{
-										pixel = static_cast<uint8_t>(current_char - '0');
-										if (pixel > max_value)
-										{
-											pixel &= (0xFF >> (8 - palette_format));
-											IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-										}
-									}
-									else if (current_char >= 'A' && current_char <= 'F')
-									{
-										pixel = 0xA + static_cast<uint8_t>(current_char - 'A');
-										if (pixel > max_value)
-										{
-											pixel &= (0xFF >> (8 - palette_format));
-											IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-										}
-									}
-									else
-									{
-										pixel = 0;
-										IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing).  This pixel will be zeroed.");
-									}
-									break;
-								}
-								case 4:
-								{
-									uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[0])));
-									if (current_char >= '0' && current_char <= '9')
-									{
-										pixel = static_cast<uint8_t>(current_char - '0');
-									}
-									else if (current_char >= 'A' && current_char <= 'F')
-									{
-										pixel = 0xA + static_cast<uint8_t>(current_char - 'A');
-									}
-									else
-									{
-										pixel = 0;
-										IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing).  This pixel will be zeroed.");
-									}
-									break;
-								}
-								case 5:
-								case 6:
-								case 7:
-								{
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[c])));
-										if (current_char >= '0' && current_char <= '9')
-										{
-											pixel |= (static_cast<uint8_t>(current_char - '0') << ((token.size() - 1 - c) << 2));
-										}
-										else if (current_char >= 'A' && current_char <= 'F')
-										{
-											pixel |= ((0xA + static_cast<uint8_t>(current_char - 'A')) << ((token.size() - 1 - c) << 2));
-										}
-										else
-										{
-											pixel = 0;
-											IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing).  This will be zeroed.");
-											break;
-										}
-									}
-									if (pixel > max_value)
-									{
-										pixel &= (0xFF >> (8 - palette_format));
-										IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-									}
-									break;
-								}
-								case 8:
-								{
-									for (size_t c = 0; c < token.size(); ++c)
-									{
-										uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[c])));
-										if (current_char >= '0' && current_char <= '9')
-										{
-											pixel |= (static_cast<uint8_t>(current_char - '0') << ((token.size() - 1 - c) << 2));
-										}
-										else if (current_char >= 'A' && current_char <= 'F')
-										{
-											pixel |= ((0xA + static_cast<uint8_t>(current_char - 'A')) << ((token.size() - 1 - c) << 2));
-										}
-										else
-										{
-											pixel = 0;
-											IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing).  This will be zeroed.");
-											break;
-										}
-									}
-									break;
-								}
-							}
-							break;
-						}
-					}
-					return pixel;
-				};
-				switch (line_data[i])
-				{
-					case ';':
-					{
-						if (!comment)
-						{
-							comment = true;
-						}
-						break;
-					}
-					case ' ':
-					{
-						if (!comment)
-						{
-							if (token.size() > 0)
-							{
-								if (token_type == TokenType::None)
-								{
-									if (current_draw_mode == DrawMode::Hexadecimal && token.size() == 1)
-									{
-										draw_pixel = true;
-									}
-									if (!draw_pixel)
-									{
-										for (size_t c = 0; c < token.size(); ++c)
-										{
-											u_token += toupper(static_cast<unsigned char>(token[c]));
-										}
-										bool valid_token = false;
-										bool legal_token = false;
-										for (auto t : TokenList)
-										{
-											if (u_token == t)
-											{
-												valid_token = true;
-												if (t == "DRAW")
-												{
-													legal_token = true;
-													token_type = TokenType::Draw;
-												}
-												break;
-											}
-										}
-										if (!valid_token)
-										{
-											error = true;
-											error_type = ErrorType::InvalidToken;
-											break;
-										}
-										else if (!legal_token)
-										{
-											error = true;
-											error_type = ErrorType::IllegalToken;
-											break;
-										}
-										token = "";
-										u_token = "";
-									}
-									else
-									{
-										uint8_t pixel = ProcessPixel();
-										DrawPixel(pixel);
-									}
-								}
-							}
-						}
-						break;
-					}
-					case '\0':
-					{
-						if (token.size() > 0)
-						{
-							if (current_draw_mode == DrawMode::Hexadecimal && token_type == TokenType::None && token.size() == 1)
-							{
-								draw_pixel = true;
-							}
-							if (!draw_pixel)
-							{
-								bool valid_token = false;
-								bool legal_token = false;
-								for (size_t c = 0; c < token.size(); ++c)
-								{
-									u_token += toupper(static_cast<unsigned char>(token[c]));
-								}
-								switch (token_type)
-								{
-									case TokenType::None:
-									{
-										for (auto t : TokenList)
-										{
-											if (u_token == t)
-											{
-												valid_token = true;
-												if (t == "DRAW")
-												{
-													legal_token = true;
-													token_type = TokenType::Draw;
-													error = true;
-													error_type = ErrorType::MissingOperand;
-													break;
-												}
-												break;
-											}
-										}
-										if (!valid_token)
-										{
-											error = true;
-											error_type = ErrorType::InvalidToken;
-										}
-										else if (!legal_token)
-										{
-											error = true;
-											error_type = ErrorType::IllegalToken;
-										}
-										break;
-									}
-									case TokenType::Draw:
-									{
-										bool valid_token = false;
-										for (auto t : ToggleList)
-										{
-											if (u_token == t)
-											{
-												valid_token = true;
-												if (t == "OFF")
-												{
-													draw = false;
-													current_draw_coordinates = { 0, 0 };
-													FontCharacterTable.push_back(std::move(CurrentFontCharacter));	
-												}
-												break;
-											}
-										}
-										if (!valid_token)
-										{
-											error = true;
-											error_type = ErrorType::InvalidToken;
-										}
-										break;
-									}
-								}
-							}
-							else
-							{
-								uint8_t pixel = ProcessPixel();
-								DrawPixel(pixel);
-								current_draw_coordinates.x = 0;
-								if (current_draw_coordinates.y < current_max_font_size.height)
-								{
-									++current_draw_coordinates.y;
-								}
-							}
-						}
-						else
-						{
-							if (draw_pixel)
-							{
-								current_draw_coordinates.x = 0;
-								if (current_draw_coordinates.y < current_max_font_size.height)
-								{
-									++current_draw_coordinates.y;
-								}
-							}
-						}
-						break;
-					}
-					default:
-					{
-						if (!comment)
-						{
-							if (token.size() == 0)
-							{
-								if (token_type == TokenType::None)
-								{
-									if (isdigit(static_cast<unsigned char>(line_data[i])))
-									{
-										draw_pixel = true;
-									}
-									else if (isspace(static_cast<unsigned char>(line_data[i])))
-									{
-										break;
-									}
-									token += line_data[i];
-								}
-								else if (token_type == TokenType::Draw)
-								{
-									if (isspace(static_cast<unsigned char>(line_data[i])))
-									{
-										break;
-									}
-									token += line_data[i];
-								}
-							}
-							else
-							{
-								if (current_draw_mode == DrawMode::Hexadecimal && token_type == TokenType::None && !draw_pixel)
-								{
-									uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<uint8_t>(line_data[i])));
-									if (token.size() == 1 && (isdigit(current_char) || (current_char >= 'A' && current_char <= 'F')))
-									{
-										draw_pixel = true;
-									}
-								}
-								if (isspace(static_cast<unsigned char>(line_data[i])))
-								{
-									break;
-								}
-								else if (draw_pixel)
-								{
-									bool ready_to_draw = false;
-									uint8_t pixel = 0;
-									switch (current_draw_mode)
-									{
-										case DrawMode::Binary:
-										{
-											if (token.size() == palette_format)
-											{
-												ready_to_draw = true;
-												for (size_t c = 0; c < palette_format; ++c)
-												{
-													if (token[c] == '1')
-													{
-														pixel |= (palette_format >> c);
-													}
-													else if (token[c] != '0')
-													{
-														pixel = 0;
-														IssueWarning("Unsupported value (must be 0s or 1s in binary drawing mode).  This pixel will be zeroed.");
-														break;
-													}
-												}
-											}
-											break;
-										}
-										case DrawMode::Octal:
-										{
-											uint8_t max_value = (0xFF >> (8 - palette_format));
-											switch (palette_format)
-											{
-												case 1:
-												case 2:
-												{
-													if (token.size() == 1)
-													{
-														ready_to_draw = true;
-														if (token[0] >= '0' && token[0] <= '7')
-														{
-															pixel = static_cast<uint8_t>(token[0] - '0');
-															if (pixel > max_value)
-															{
-																pixel &= (0xFF >> (8 - palette_format));
-																IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-															}
-														}
-														else
-														{
-															pixel = 0;
-															IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-														}
-													}
-													break;
-												}
-												case 3:
-												{
-													if (token.size() == 1)
-													{
-														ready_to_draw = true;
-														if (token[0] >= '0' && token[0] <= '7')
-														{
-															pixel = static_cast<uint8_t>(token[0] - '0');
-														}
-														else
-														{
-															pixel = 0;
-															IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-														}
-													}
-													break;
-												}
-												case 4:
-												case 5:
-												{
-													if (token.size() == 2)
-													{
-														ready_to_draw = true;
-														for (size_t c = 0; c < 2; ++c)
-														{
-															if (token[c] >= '0' && token[c] <= '7')
-															{
-																pixel |= (static_cast<uint8_t>(token[c] - '0') << (3 * (1 - c)));
-															}
-															else
-															{
-																pixel = 0;
-																IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-														if (pixel > max_value)
-														{
-															pixel &= (0xFF >> (8 - palette_format));
-															IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-														}
-													}
-													break;
-												}
-												case 6:
-												{
-													if (token.size() == 2)
-													{
-														ready_to_draw = true;
-														for (size_t c = 0; c < 2; ++c)
-														{
-															if (token[c] >= '0' && token[c] <= '7')
-															{
-																pixel |= (static_cast<uint8_t>(token[c] - '0') << (3 * (1 - c)));
-															}
-															else
-															{
-																pixel = 0;
-																IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-													}
-													break;
-												}
-												case 7:
-												case 8:
-												{
-													bool overflow = false;
-													if (token.size() == 3)
-													{
-														ready_to_draw = true;
-														for (size_t c = 0; c < 3; ++c)
-														{
-															if (token[c] >= '0' && token[c] <= '7')
-															{
-																uint8_t digit = static_cast<uint8_t>(token[c] - '0');
-																if (c == 0 && digit > 3)
-																{
-																	overflow = true;
-																}
-																pixel |= static_cast<uint8_t>(digit << (3 * (2 - c)));
-															}
-															else
-															{
-																pixel = 0;
-																if (overflow)
-																{
-																	overflow = false;
-																}
-																IssueWarning("Unsupported value (must be 0-7s in octal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-														if (pixel > max_value)
-														{
-															if (!overflow)
-															{
-																overflow = true;
-															}
-															pixel &= (0xFF >> (8 - palette_format));
-														}
-														if (overflow)
-														{
-															IssueWarning("Value is beyond the maximum limit for the palette format used while in octal drawing mode.  This pixel will be truncated to fit.");
-														}
-													}
-													break;
-												}
-											}
-											break;
-										}
-										case DrawMode::Decimal:
-										{
-											uint8_t max_value = (0xFF >> (8 - palette_format));
-											switch (palette_format)
-											{
-												case 1:
-												case 2:
-												case 3:
-												{
-													if (token.size() == 1)
-													{
-														ready_to_draw = true;
-														if (token[0] >= '0' && token[0] <= '9')
-														{
-															pixel = static_cast<uint8_t>(token[0] - '0');
-															if (pixel > max_value)
-															{
-																pixel &= (0xFF >> (8 - palette_format));
-																IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-															}
-														}
-														else
-														{
-															pixel = 0;
-															IssueWarning("Unsupported value (must be 0-9s in decimal drawing mode).  This pixel will be zeroed.");
-														}
-													}
-													break;
-												}
-												case 4:
-												case 5:
-												case 6:
-												{
-													if (token.size() == 2)
-													{
-														uint8_t digit = 10;
-														ready_to_draw = true;
-														for (size_t c = 0; c < 2; ++c)
-														{
-															if (token[c] >= '0' && token[c] <= '9')
-															{
-																pixel += (static_cast<uint8_t>(token[c] - '0') * digit);
-																digit /= 10;
-															}
-															else
-															{
-																pixel = 0;
-																IssueWarning("Unsupported value (must be 0-9s in decimal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-														if (pixel > max_value)
-														{
-															pixel &= (0xFF >> (8 - palette_format));
-															IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-														}
-													}
-													break;
-												}
-												case 7:
-												case 8:
-												{
-													bool overflow = false;
-													if (token.size() == 3)
-													{
-														uint8_t digit = 100;
-														ready_to_draw = true;
-														for (size_t c = 0; c < 3; ++c)
-														{
-															if (token[c] >= '0' && token[c] <= '9')
-															{
-																uint8_t tmp = pixel;
-																pixel += (static_cast<uint8_t>(token[c] - '0') * digit);
-																digit /= 10;
-																if (tmp > pixel && !overflow)
-																{
-																	overflow = true;
-																}
-															}
-															else
-															{
-																pixel = 0;
-																if (overflow)
-																{
-																	overflow = false;
-																}
-																IssueWarning("Unsupported value (must be 0-9s in decimal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-														if (pixel > max_value)
-														{
-															if (!overflow)
-															{
-																overflow = true;
-															}
-															pixel &= (0xFF >> (8 - palette_format));
-														}
-														if (overflow)
-														{
-															IssueWarning("Value is beyond the maximum limit for the palette format used while in decimal drawing mode.  This pixel will be truncated to fit.");
-														}
-													}
-													break;
-												}
-											}
-											break;
-										}
-										case DrawMode::Hexadecimal:
-										{
-											uint8_t max_value = (0xFF >> (8 - palette_format));
-											switch (palette_format)
-											{
-												case 1:
-												case 2:
-												case 3:
-												{
-													if (token.size() == 1)
-													{
-														ready_to_draw = true;
-														uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[0] - '0')));
-														if (current_char >= '0' && current_char <= '9')
-														{
-															pixel = static_cast<uint8_t>(current_char - '0');
-															if (pixel > max_value)
-															{
-																pixel &= (0xFF >> (8 - palette_format));
-																IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-															}
-														}
-														else if (current_char >= 'A' && current_char <= 'F')
-														{
-															pixel = 0xA + static_cast<uint8_t>(current_char - 'A');
-															if (pixel > max_value)
-															{
-																pixel &= (0xFF >> (8 - palette_format));
-																IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-															}
-														}
-														else
-														{
-															pixel = 0;
-															IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing mode).  This pixel will be zeroed.");
-														}
-													}
-													break;
-												}
-												case 4:
-												{
-													if (token.size() == 1)
-													{
-														ready_to_draw = true;
-														uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[0])));
-														if (current_char >= '0' && current_char <= '9')
-														{
-															pixel = static_cast<uint8_t>(current_char - '0');
-														}
-														else if (current_char >= 'A' && current_char <= 'F')
-														{
-															pixel = 0xA + static_cast<uint8_t>(current_char - 'A');
-														}
-														else
-														{
-															pixel = 0;
-															IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing mode).  This pixel will be zeroed.");
-														}
-													}
-													break;
-												}
-												case 5:
-												case 6:
-												case 7:
-												{
-													if (token.size() == 2)
-													{
-														ready_to_draw = true;
-														for (size_t c = 0; c < 2; ++c)
-														{
-															uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[c])));
-															if (current_char >= '0' && current_char <= '9')
-															{
-																pixel |= (static_cast<uint8_t>(current_char - '0') << ((1 - c) << 2)); 
-															}
-															else if (current_char >= 'A' && current_char <= 'F')
-															{
-																pixel |= ((0xA + static_cast<uint8_t>(current_char - 'A')) << ((1 - c) << 2));
-															}
-															else
-															{
-																pixel = 0;
-																IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-														if (pixel > max_value)
-														{
-															pixel &= (0xFF >> (8 - palette_format));
-															IssueWarning("Value is beyond the maximum limit for the palette format used while in hexadecimal drawing mode.  This pixel will be truncated to fit.");
-														}
-													}
-													break;
-												}
-												case 8:
-												{
-													if (token.size() == 2)
-													{
-														ready_to_draw = true;
-														for (size_t c = 0; c < 2; ++c)
-														{
-															uint8_t current_char = static_cast<uint8_t>(toupper(static_cast<unsigned char>(token[c])));
-															if (current_char >= '0' && current_char <= '9')
-															{
-																pixel |= (static_cast<uint8_t>(current_char - '0') << ((1 - c) << 2));
-															}
-															else if (current_char >= 'A' && current_char <= 'F')
-															{
-																pixel |= ((0xA + static_cast<uint8_t>(current_char - 'A')) << ((1 - c) << 2));
-															}
-															else
-															{
-																pixel = 0;
-																IssueWarning("Unsupported value (must be 0-Fs in hexadecimal drawing mode).  This pixel will be zeroed.");
-																break;
-															}
-														}
-													}
-													break;
-												}
-											}
-											break;
-										}
-									}
-									if (ready_to_draw)
-									{
-										DrawPixel(pixel);
-									}
-								}
-								token += line_data[i];
-							}
-						}
-						break;
-					}
-				}
-			}
-			if (error)
-			{
-				++error_count;
-				fmt::print("Error at {}:{} : ", current_line_number, i - token.size());
-				switch (error_type)
+				if (!ParseNumber(value, NumberFormat::Decimal, thread_count))
 				{
-					case ErrorType::InvalidToken:
-					{
-						fmt::print("Invalid Token '{}'\n", reinterpret_cast<const char *>(token.c_str()));
-						break;
-					}
-					case ErrorType::MissingOperand:
-					{
-						fmt::print("Missing Operand for ");
-						switch (token_type)
-						{
-							case TokenType::CurrentFontWidth:
-							{
-								fmt::print("CURRENT_FONT_WIDTH\n");
-								break;
-							}
-							case TokenType::Draw:
-							{
-								fmt::print("DRAW\n");
-								break;
-							}
-							case TokenType::DrawMode:
-							{
-								fmt::print("DRAW_MODE\n");
-								break;
-							}
-							case TokenType::FontName:
-							{
-								fmt::print("FONT_NAME\n");
-								break;
-							}
-							case TokenType::Language:
-							{
-								fmt::print("LANGUAGE\n");
-								break;
-							}
-							case TokenType::MaxFontSize:
-							{
-								fmt::print("MAX_FONT_SIZE\n");
-								break;
-							}
-							case TokenType::PaletteFormat:
-							{
-								fmt::print("PALETTE_FORMAT\n");
-								break;
-							}
-							case TokenType::SpacingType:
-							{
-								fmt::print("SPACING_TYPE\n");
-								break;
-							}
-						}
-						break;
-					}
-					case ErrorType::InvalidValue:
-					{
-						fmt::print("Invalid Value\n");
-						break;
-					}
-					case ErrorType::IllegalToken:
-					{
-						fmt::print("Illegal Token being used when drawing.\n");
-						break;
-					}
-					case ErrorType::UnsupportedPaletteFormat:
-					{
-						fmt::print("Palette Format being specified is unsupported (must be between 1 and 8).\n");
-						break;
-					}
-					case ErrorType::UnsupportedMaxFontSize:
-					{
-						fmt::print("Max Font Size being specified is unsupported (both width and height must be between 1 and 256).\n");
-						break;
-					}
-					case ErrorType::StringRequirement:
-					{
-						switch (token_type)
-						{
-							case TokenType::FontName:
-							{
-								fmt::print("FONT_NAME ");
-								break;
-							}
-							case TokenType::Language:
-							{
-								fmt::print("LANGUAGE ");
-								break;
-							}
-						}
-						fmt::print("must be stored as a string.\n");
-						break;
-					}
-					default:
-					{
-						fmt::print("Unknown Error\n");
-						break;
-					}
+					fmt::print(console, "Invalid thread count '{}'.\n", value);
+					return false;
 				}
-				break;
+				batch = true;
 			}
 		}
-		++current_line_number;
+		else
+		{
+			Inputs.push_back(Args[i]);
+		}
 	}
-	if (error_count == 0)
+	if (Inputs.size() == 0)
+	{
+		PrintFormat();
+		return false;
+	}
+	if (decode_thread_count != 1 && (stream || batch || Inputs.size() != 1))
+	{
+		fmt::print(console, "'--decode-threads' can only be used when assembling a single input file without '--stream'.\n");
+		return false;
+	}
+	if (watch && (stream || batch || Inputs.size() != 1))
+	{
+		fmt::print(console, "'--watch' can only be used when assembling a single input file without '--stream'.\n");
+		return false;
+	}
+	if (!cache_directory.empty() && stream)
+	{
+		fmt::print(console, "'--cache' cannot be used with '--stream'.\n");
+		return false;
+	}
+	if (from_bdf && (decode_thread_count != 1 || !cache_directory.empty()))
+	{
+		fmt::print(console, "'--from-bdf' cannot be used with '--decode-threads' or '--cache'.\n");
+		return false;
+	}
+	if (output_format == OutputFormat::CxxHeader && stream)
+	{
+		fmt::print(console, "'--emit=cxx-header' cannot be used with '--stream'.\n");
+		return false;
+	}
+	if (dedupe_report && stream)
 	{
-		header_descriptor.palette_format = palette_format - 1;
-		header_descriptor.max_font_width = static_cast<uint8_t>(current_max_font_size.width - 1);
-		header_descriptor.max_font_height = static_cast<uint8_t>(current_max_font_size.height - 1);
-		if (current_spacing_type == SpacingType::Variable)
+		fmt::print(console, "'--dedupe-report' cannot be used with '--stream'.\n");
+		return false;
+	}
+	if (!output_path.empty())
+	{
+		if (batch || Inputs.size() != 1)
 		{
-			header_descriptor.flags |= 0x01;
+			fmt::print(console, "'-o' can only be used when assembling a single input file.\n");
+			return false;
 		}
-		header_descriptor.font_character_count = static_cast<uint32_t>(FontCharacterTable.size());
-		size_t font_name_len = font_name.size();
-		if (font_name_len > 0)
+		if (watch && (Inputs[0] == "-" || output_path == "-"))
 		{
-			if (font_name_len > 64)
-			{
-				font_name_len = 64;
-			}
-			memcpy(header_descriptor.font_name, font_name.c_str(), font_name_len);
+			fmt::print(console, "'--watch' cannot be used with standard input or output ('-').\n");
+			return false;
 		}
-		size_t language_len = language.size();
-		if (language_len > 0)
+		if (!cache_directory.empty() && Inputs[0] == "-")
 		{
-			if (language_len > 64)
-			{
-				language_len = 64;
-			}
-			memcpy(header_descriptor.language, language.c_str(), language_len);
+			fmt::print(console, "'--cache' cannot be used with standard input ('-').\n");
+			return false;
 		}
-		msbtfont_create_header(&header, &header_descriptor);
-		msbtfont_filedata font_filedata;
-		msbtfont_create_filedata(&header, &font_filedata);
-		for (uint32_t i = 0; i < FontCharacterTable.size(); ++i)
+		if (stream && output_path == "-")
 		{
-			if (current_spacing_type == SpacingType::Variable && FontCharacterTable[i].width != 0)
-			{
-				font_filedata.variable_table[i] = FontCharacterTable[i].width - 1;
-			}
-			msbtfont_store_font_character_data(&header, &font_filedata, FontCharacterTable[i].character.data(), i);
+			fmt::print(console, "'--stream' rewrites the header once assembly is done, so it cannot write to standard output ('-').\n");
+			return false;
+		}
+		Jobs.push_back({ Inputs[0], output_path });
+		return true;
+	}
+	batch = true;
+	for (const auto &Input : Inputs)
+	{
+		if (!output_directory.empty())
+		{
+			std::filesystem::path input_path(Input);
+			Jobs.push_back({ Input, (std::filesystem::path(output_directory) / input_path.stem()).string() + ((output_format == OutputFormat::CxxHeader) ? ".hpp" : ".msbtfont") });
+			continue;
 		}
-		output_file.write(reinterpret_cast<char *>(&header), sizeof(header));
-		if (current_spacing_type == SpacingType::Variable)
+		// Skip a drive letter so 'C:\\font.txt:C:\\font.msbtfont' splits in the right place.
+		size_t separator = Input.find(':', (Input.size() > 2 && Input[1] == ':') ? 2 : 0);
+		if (separator == std::string::npos || separator == 0 || separator + 1 == Input.size())
 		{
-			output_file.write(reinterpret_cast<char *>(font_filedata.variable_table), FontCharacterTable.size());
+			fmt::print(console, "You need to specify an output file for '{}' (use [input]:[output], '--out-dir' or '-o').\n", Input);
+			return false;
 		}
-		size_t font_data_size = (current_max_font_size.width * current_max_font_size.height * palette_format * FontCharacterTable.size()) / 8;
-		if ((current_max_font_size.width * current_max_font_size.height * palette_format * FontCharacterTable.size()) % 8)
+		Jobs.push_back({ Input.substr(0, separator), Input.substr(separator + 1) });
+		if (Jobs.back().input_path == "-" || Jobs.back().output_path == "-")
 		{
-			++font_data_size;
+			fmt::print(console, "Standard input and output ('-') can only be used with '-o'.\n");
+			return false;
 		}
-		output_file.write(reinterpret_cast<char *>(font_filedata.font_data), font_data_size);
-		msbtfont_delete_filedata(&font_filedata);
-		fmt::print("Assembly successful!\n");
-		fmt::print("{} character{} {} assembled in total.\n", FontCharacterTable.size(), (FontCharacterTable.size() != 1) ? "s" : "", (FontCharacterTable.size() != 1) ? "were" : "was");
 	}
-	fmt::print("There {} {} error{} and {} warning{}.\n", ((error_count != 1) ? "were" : "was"), error_count, ((error_count != 1) ? "s" : ""), warning_count, ((warning_count != 1) ? "s" : ""));
+	// The jobs run at the same time, so two writing the same file would silently overwrite each other.
+	std::unordered_map<std::string, const AssemblyJob *> OutputJobs;
+	for (const auto &Job : Jobs)
+	{
+		std::error_code error;
+		std::string output_key = std::filesystem::absolute(Job.output_path, error).lexically_normal().string();
+		auto [Entry, inserted] = OutputJobs.try_emplace(output_key, &Job);
+		if (!inserted)
+		{
+			fmt::print(console, "'{}' and '{}' would both be written to '{}'.\n", Entry->second->input_path, Job.input_path, Job.output_path);
+			return false;
+		}
+	}
+	return true;
 }
 
-bool MisbitFontAssembler::Application::GetExit() const
+// One cache file per input, named after its stem and a hash of its absolute path.
+std::string MisbitFontAssembler::Application::GetCachePath(const std::string &input_path) const
 {
-	return exit;
+	std::error_code error;
+	std::filesystem::create_directories(cache_directory, error);
+	std::string absolute_path = std::filesystem::absolute(input_path, error).string();
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (char c : absolute_path)
+	{
+		hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+	}
+	return (std::filesystem::path(cache_directory) / fmt::format("{}-{:016x}.msbtcache", std::filesystem::path(input_path).stem().string(), hash)).string();
 }
 
-int MisbitFontAssembler::Application::GetReturnCode() const
+bool MisbitFontAssembler::Application::AssembleFile(const AssemblyJob &Job, Assembler &JobAssembler, Diagnostics &JobDiagnostics)
 {
-	return retcode;
+	if (Job.output_path == Job.input_path && Job.input_path != "-")
+	{
+		JobDiagnostics.Message(fmt::format("Do not specify the output file as the input file ('{}').", Job.input_path));
+		return false;
+	}
+	InputReader input_file;
+	if (!input_file.Open(Job.input_path))
+	{
+		JobDiagnostics.Message(fmt::format("Unable to open '{}'.", Job.input_path));
+		return false;
+	}
+	JobDiagnostics.Message(fmt::format("Attempting to {} {} to {}...", from_bdf ? "import" : "assemble", Job.input_path, Job.output_path));
+	uint64_t allocation_count = GetThreadAllocationCount();
+	Statistics JobStatistics;
+	Statistics *Stats = stats ? &JobStatistics : nullptr;
+	StreamEmitter FontStream(Stats);
+	if (stream && !FontStream.Open(Job.output_path))
+	{
+		JobDiagnostics.Message(fmt::format("Unable to write '{}'.", Job.output_path));
+		return false;
+	}
+	GlyphCache JobCache;
+	GlyphCache *Cache = nullptr;
+	std::string cache_path = cache_directory.empty() ? "" : GetCachePath(Job.input_path);
+	if (watch)
+	{
+		// Kept in memory between rebuilds, so only the characters changed by a save are decoded again.
+		Cache = &WatchCache;
+	}
+	else if (!cache_path.empty())
+	{
+		PhaseScope ReadScope(Stats, Phase::Read);
+		JobCache.Load(cache_path);
+		Cache = &JobCache;
+	}
+	AssemblerOptions Options;
+	Options.input_format = from_bdf ? InputFormat::Bdf : InputFormat::Source;
+	Options.source_name = Job.input_path;
+	Options.file_access = true;
+	Options.decode_thread_count = decode_thread_count;
+	Options.Includes = &Includes;
+	Options.Cache = Cache;
+	Options.Stats = Stats;
+	JobAssembler.Parse(input_file, JobDiagnostics, Options, stream ? &FontStream : nullptr);
+	if (JobAssembler.IsCacheUpdated())
+	{
+		JobDiagnostics.Message(fmt::format("Glyph cache: {} hit{}, {} miss{}.", Cache->GetHitCount(), (Cache->GetHitCount() != 1) ? "s" : "", Cache->GetMissCount(), (Cache->GetMissCount() != 1) ? "es" : ""));
+		PhaseScope WriteScope(Stats, Phase::Write);
+		if (!cache_path.empty() && !Cache->Save(cache_path))
+		{
+			JobDiagnostics.Message(fmt::format("Unable to write glyph cache '{}'.", cache_path));
+		}
+		if (watch)
+		{
+			Cache->Advance();
+		}
+	}
+	const FontData &Font = JobAssembler.GetFontData();
+	bool success = false;
+	size_t error_count = JobDiagnostics.GetErrorCount();
+	if (error_count == 0)
+	{
+		Emitter FontEmitter(Stats);
+		// While watching, the output is replaced atomically so whatever reads it never sees a partial font.
+		std::string write_path = watch ? Job.output_path + ".tmp" : Job.output_path;
+		bool written = false;
+		if (stream)
+		{
+			written = FontStream.Finish(Font);
+		}
+		else if (output_format == OutputFormat::CxxHeader)
+		{
+			// The namespace is named after the header, or after the input when writing to standard output.
+			written = FontEmitter.WriteCxxHeader(Font, write_path, std::filesystem::path((Job.output_path == "-") ? Job.input_path : Job.output_path).stem().string());
+		}
+		else
+		{
+			written = FontEmitter.Write(Font, write_path);
+		}
+		if (watch)
+		{
+			std::error_code error;
+			if (written)
+			{
+				std::filesystem::rename(write_path, Job.output_path, error);
+				written = !error;
+			}
+			std::filesystem::remove(write_path, error);
+		}
+		if (written)
+		{
+			size_t character_count = Font.FontCharacterTable.GetCount();
+			JobDiagnostics.Message("Assembly successful!");
+			JobDiagnostics.Message(fmt::format("{} character{} {} assembled in total.", character_count, (character_count != 1) ? "s" : "", (character_count != 1) ? "were" : "was"));
+			if (dedupe_report)
+			{
+				ReportDuplicates(Font, JobDiagnostics);
+			}
+			success = true;
+		}
+		else
+		{
+			JobDiagnostics.Message(fmt::format("Unable to write '{}'.", Job.output_path));
+		}
+	}
+	if (stream && !success)
+	{
+		FontStream.Discard();
+	}
+	size_t warning_count = JobDiagnostics.GetWarningCount();
+	JobDiagnostics.Message(fmt::format("There {} {} error{} and {} warning{}.", ((error_count != 1) ? "were" : "was"), error_count, ((error_count != 1) ? "s" : ""), warning_count, ((warning_count != 1) ? "s" : "")));
+	if (Stats)
+	{
+		Stats->Report(JobDiagnostics, GetThreadAllocationCount() - allocation_count);
+	}
+	return success;
+}
+
+// Lists every group of identical characters by index, with consecutive indices shown as ranges.
+void MisbitFontAssembler::Application::ReportDuplicates(const FontData &Font, Diagnostics &JobDiagnostics) const
+{
+	GlyphInterner Interner;
+	Interner.Intern(Font);
+	size_t character_count = Font.FontCharacterTable.GetCount();
+	size_t duplicate_count = character_count - Interner.GetUniqueCount();
+	JobDiagnostics.Message(fmt::format("{} of {} character{} {} a duplicate of an earlier one ({} unique).", duplicate_count, character_count, (character_count != 1) ? "s" : "", (duplicate_count != 1) ? "are" : "is", Interner.GetUniqueCount()));
+	for (const std::vector<uint32_t> &Group : Interner.GetDuplicateGroups())
+	{
+		std::string indices;
+		for (size_t i = 0; i < Group.size(); ++i)
+		{
+			size_t last = i;
+			while (last + 1 < Group.size() && Group[last + 1] == Group[last] + 1)
+			{
+				++last;
+			}
+			indices += fmt::format("{}{}", indices.empty() ? "" : ", ", Group[i]);
+			if (last > i)
+			{
+				indices += fmt::format("-{}", Group[last]);
+			}
+			i = last;
+		}
+		JobDiagnostics.Message(fmt::format("  {} x {}", Group.size(), indices));
+	}
 }
 
 int main(int argc, char *argv[])
@@ -0,0 +1,106 @@
+#include "../include/mapped_file.hpp"
+#include <fstream>
+#include <iterator>
+#if __has_include(<sys/mman.h>)
+#define MISBITFONT_ASSEMBLER_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr uint8_t EmptyFile[1] = { 0 };
+}
+
+MisbitFontAssembler::MappedFile::MappedFile() : data(nullptr), size(0), mapped(false)
+{
+}
+
+MisbitFontAssembler::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MisbitFontAssembler::MappedFile::Open(const std::string &path)
+{
+	Close();
+#ifdef MISBITFONT_ASSEMBLER_USE_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	bool result = Map(fd);
+	::close(fd);
+	if (result)
+	{
+		return true;
+	}
+#endif
+	std::ifstream input_file(path, std::ios::binary);
+	if (!input_file.is_open())
+	{
+		return false;
+	}
+	FileData.assign(std::istreambuf_iterator<char>(input_file), std::istreambuf_iterator<char>());
+	data = FileData.empty() ? EmptyFile : FileData.data();
+	size = FileData.size();
+	return true;
+}
+
+// Maps a regular file from its descriptor, returning false for anything else (such as pipes).
+bool MisbitFontAssembler::MappedFile::Map(int file_descriptor)
+{
+	Close();
+#ifdef MISBITFONT_ASSEMBLER_USE_MMAP
+	struct stat file_status;
+	if (fstat(file_descriptor, &file_status) != 0 || !S_ISREG(file_status.st_mode))
+	{
+		return false;
+	}
+	if (file_status.st_size == 0)
+	{
+		data = EmptyFile;
+		return true;
+	}
+	void *map = mmap(nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(map, static_cast<size_t>(file_status.st_size), MADV_SEQUENTIAL);
+	data = static_cast<const uint8_t *>(map);
+	size = static_cast<size_t>(file_status.st_size);
+	mapped = true;
+	return true;
+#else
+	static_cast<void>(file_descriptor);
+	return false;
+#endif
+}
+
+void MisbitFontAssembler::MappedFile::Close()
+{
+#ifdef MISBITFONT_ASSEMBLER_USE_MMAP
+	if (mapped)
+	{
+		munmap(const_cast<uint8_t *>(data), size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+	mapped = false;
+	FileData.clear();
+}
+
+const uint8_t *MisbitFontAssembler::MappedFile::GetData() const
+{
+	return data;
+}
+
+size_t MisbitFontAssembler::MappedFile::GetSize() const
+{
+	return size;
+}
@@ -0,0 +1,1128 @@
+#include "../include/parser.hpp"
+#include "../include/keywords.hpp"
+#include "../include/number_parser.hpp"
+#include "../include/pixel_format.hpp"
+#include "../include/emitter.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/bit_writer.hpp"
+#include "../include/allocation_counter.hpp"
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <filesystem>
+#include <fmt/core.h>
+
+MisbitFontAssembler::Parser::Parser(Diagnostics &diagnostics, StreamEmitter *Stream, Statistics *Stats) : SourceDiagnostics(&diagnostics), Stream(Stream), Stats(Stats), Font { { 1, { 1, 1 }, SpacingType::Monospace, "", "" }, {} }, CurrentFontCharacter { {}, 0 }, current_line_number(1), token_type(TokenType::None), keyword_column(0), operand_seen(false), operand_count(0), line_error(false), row_drawn(false), current_draw_mode(DrawMode::Binary), current_draw_coordinates { 0, 0 }, current_font_width(0), draw(false), deferred(false), reused_character(false), cache_updated(false), pending_sheet_column(0), sheet_columns(0), sheet_rows(0), Includes(nullptr), pending_include_column(0), setting_directive_count(0), unmapped_include(false), file_access(true)
+{
+}
+
+// Returns to the state of a new Parser for another source, keeping the memory of the previous one.
+void MisbitFontAssembler::Parser::Reset(Diagnostics &diagnostics, StreamEmitter *Stream, Statistics *Stats)
+{
+	SourceDiagnostics = &diagnostics;
+	this->Stream = Stream;
+	this->Stats = Stats;
+	Font.Settings = { 1, { 1, 1 }, SpacingType::Monospace, "", "" };
+	Font.FontCharacterTable.Clear();
+	CurrentFontCharacter.width = 0;
+	current_line_number = 1;
+	token_type = TokenType::None;
+	keyword_column = 0;
+	operand_seen = false;
+	line_error = false;
+	row_drawn = false;
+	current_draw_mode = DrawMode::Binary;
+	current_draw_coordinates = { 0, 0 };
+	current_font_width = 0;
+	draw = false;
+	deferred = false;
+	DeferredCharacters.clear();
+	DeferredLines.clear();
+	DeferredCopies.clear();
+	Includes = nullptr;
+	IncludeStack.clear();
+	IncludeNames.clear();
+	IncludedFiles.clear();
+	IncludedSources.clear();
+	setting_directive_count = 0;
+	unmapped_include = false;
+	reused_character = false;
+	cache_updated = false;
+	SourceDiagnostics->SetIncludedFile("");
+}
+
+void MisbitFontAssembler::Parser::Parse(InputReader &input)
+{
+	std::string_view line;
+	{
+		PhaseScope ReadScope(Stats, Phase::Read);
+		while (input.NextLine(line))
+		{
+			ParseLine(line);
+		}
+	}
+	Finish();
+	if (!deferred)
+	{
+		DecodedCharacters.Clear();
+		Decoded.clear();
+	}
+}
+
+void MisbitFontAssembler::Parser::ParseLine(std::string_view line)
+{
+	if (Stats)
+	{
+		Stats->Count(Counter::Lines);
+	}
+	if (draw && (deferred || reused_character))
+	{
+		if (!IsDrawLine(line))
+		{
+			if (deferred)
+			{
+				DeferredLines.push_back(line);
+			}
+			++current_line_number;
+			return;
+		}
+	}
+	else if (draw)
+	{
+		PhaseScope DecodeScope(Stats, Phase::Decode);
+		if (DecodePixelRow(line))
+		{
+			++current_line_number;
+			return;
+		}
+	}
+	PhaseScope TokenizeScope(Stats, Phase::Tokenize);
+	LineLexer.Reset(line);
+	token_type = TokenType::None;
+	operand_seen = false;
+	operand_count = 0;
+	line_error = false;
+	row_drawn = false;
+	Lexeme lexeme;
+	while (!line_error && LineLexer.Next(lexeme))
+	{
+		if (operand_seen)
+		{
+			Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+		}
+		else if (token_type != TokenType::None)
+		{
+			ParseOperand(lexeme);
+		}
+		else if (draw)
+		{
+			ParseDrawToken(lexeme);
+		}
+		else
+		{
+			ParseCommand(lexeme);
+		}
+	}
+	if (!line_error && token_type != TokenType::None && !operand_seen)
+	{
+		Error(keyword_column, ErrorType::MissingOperand);
+	}
+	if (draw && row_drawn)
+	{
+		current_draw_coordinates.x = 0;
+		if (current_draw_coordinates.y < Font.Settings.max_font_size.height)
+		{
+			++current_draw_coordinates.y;
+		}
+	}
+	if (token_type == TokenType::Include && operand_seen && !line_error)
+	{
+		ParseInclude(pending_include_column);
+	}
+	else if (token_type == TokenType::ImportSheet && operand_seen && !line_error)
+	{
+		ImportSheet(pending_sheet_column);
+	}
+	++current_line_number;
+}
+
+void MisbitFontAssembler::Parser::Finish()
+{
+	if (draw)
+	{
+		SourceDiagnostics->Warning(current_line_number - 1, 0, WarningType::UnfinishedCharacter);
+		draw = false;
+		reused_character = false;
+		if (deferred)
+		{
+			// Still decoded, as the serial path would report its diagnostics.
+			DeferredCharacters.back().line_count = DeferredLines.size() - DeferredCharacters.back().first_line;
+		}
+	}
+}
+
+const MisbitFontAssembler::FontData &MisbitFontAssembler::Parser::GetFontData() const
+{
+	return Font;
+}
+
+MisbitFontAssembler::FontData MisbitFontAssembler::Parser::TakeFontData()
+{
+	return std::move(Font);
+}
+
+void MisbitFontAssembler::Parser::SetDeferredDecoding(bool deferred)
+{
+	this->deferred = deferred;
+}
+
+// The path of the source, which includes are relative to.  Sources without one (such as standard input) include relative to the working directory.
+void MisbitFontAssembler::Parser::SetSourcePath(std::string_view path)
+{
+	IncludeStack.clear();
+	if (!path.empty() && path != "-")
+	{
+		std::error_code error;
+		std::filesystem::path source_path(path);
+		std::filesystem::path canonical_path = std::filesystem::weakly_canonical(source_path, error);
+		IncludeStack.push_back((error ? source_path : canonical_path).string());
+	}
+}
+
+void MisbitFontAssembler::Parser::SetIncludeCache(IncludeCache *Includes)
+{
+	this->Includes = Includes;
+}
+
+// Whether include and import_sheet may open files, which they report as errors otherwise.
+void MisbitFontAssembler::Parser::SetFileAccess(bool file_access)
+{
+	this->file_access = file_access;
+}
+
+bool MisbitFontAssembler::Parser::DecodeDeferredCharacters(size_t thread_count, GlyphCache *Cache)
+{
+	// The lines of an include that could not be mapped are gone by now.
+	if (unmapped_include)
+	{
+		DeferredCharacters.clear();
+		DeferredLines.clear();
+		DeferredCopies.clear();
+		cache_updated = false;
+		return false;
+	}
+	// Cache lookups are read-only on the workers; what each task hit or packed is merged into the cache afterwards.
+	struct TaskResult
+	{
+		std::vector<GlyphKey> Hits;
+		std::vector<std::pair<GlyphKey, std::vector<uint8_t>>> Misses;
+		std::vector<uint32_t> Decoded;
+		uint64_t allocation_count = 0;
+	};
+	std::atomic<bool> clean = true;
+	std::vector<TaskResult> Results;
+	{
+		ThreadPool Pool(thread_count, DeferredCharacters.size());
+		if (!Pool.HasStarted())
+		{
+			SourceDiagnostics->Error(0, 0, ErrorType::ThreadStartFailed, TokenType::None, "");
+			DeferredCharacters.clear();
+			DeferredLines.clear();
+			DeferredCopies.clear();
+			cache_updated = false;
+			return true;
+		}
+		// A few tasks per thread so the work-stealing pool can even out characters of different costs.
+		size_t task_count = Pool.GetThreadCount() * 4;
+		size_t characters_per_task = std::max<size_t>((DeferredCharacters.size() + task_count - 1) / task_count, 1);
+		Results.resize((DeferredCharacters.size() + characters_per_task - 1) / characters_per_task);
+		for (size_t first = 0, task = 0; first < DeferredCharacters.size(); first += characters_per_task, ++task)
+		{
+			size_t last = std::min(first + characters_per_task, DeferredCharacters.size());
+			Pool.Submit([this, first, last, Cache, &Result = Results[task], &clean]()
+			{
+				uint64_t allocation_count = GetThreadAllocationCount();
+				Diagnostics CharacterDiagnostics;
+				Parser CharacterParser(CharacterDiagnostics);
+				size_t packed_size = (Font.FontCharacterTable.GetCharacterBits() + 7) / 8;
+				for (size_t i = first; i < last; ++i)
+				{
+					const DeferredCharacter &Character = DeferredCharacters[i];
+					GlyphKey Key {};
+					if (Cache && Character.index != DeferredCharacter::NoIndex)
+					{
+						Key = HashCharacter(DeferredLines.data() + Character.first_line, Character.line_count, Font.Settings, Character.draw_mode, Character.width);
+						const std::vector<uint8_t> *Packed = Cache->Find(Key);
+						if (Packed && Packed->size() == packed_size)
+						{
+							Font.FontCharacterTable.StorePacked(Character.index, Packed->data());
+							Result.Hits.push_back(Key);
+							Result.Decoded.push_back(Character.index);
+							continue;
+						}
+					}
+					if (!CharacterParser.DecodeDeferredCharacter(Font.Settings, Character, DeferredLines.data()))
+					{
+						// Left for the serial pass to decode again and report, while the rest still count.
+						CharacterDiagnostics.Reset();
+						clean = false;
+						continue;
+					}
+					if (Character.index == DeferredCharacter::NoIndex)
+					{
+						continue;
+					}
+					Result.Decoded.push_back(Character.index);
+					if (Cache)
+					{
+						std::vector<uint8_t> Packed(packed_size, 0);
+						PackPixels(Font.Settings.palette_format, CharacterParser.CurrentFontCharacter.character.data(), Font.FontCharacterTable.GetCharacterBits() / Font.Settings.palette_format, Packed.data());
+						Font.FontCharacterTable.StorePacked(Character.index, Packed.data());
+						Result.Misses.emplace_back(Key, std::move(Packed));
+					}
+					else
+					{
+						Font.FontCharacterTable.Store(Character.index, CharacterParser.CurrentFontCharacter.character.data());
+					}
+				}
+				Result.allocation_count = GetThreadAllocationCount() - allocation_count;
+			});
+		}
+		Pool.Wait();
+	}
+	if (Stats)
+	{
+		for (const TaskResult &Result : Results)
+		{
+			Stats->Count(Counter::WorkerAllocations, Result.allocation_count);
+		}
+	}
+	// Copies are stored in order, as one may copy another.
+	if (clean && !DeferredCopies.empty())
+	{
+		GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+		CopiedCharacter.resize((FontCharacterTable.GetCharacterBits() + 7) / 8);
+		for (const DeferredCopy &Copy : DeferredCopies)
+		{
+			FontCharacterTable.CopyPacked(Copy.source, CopiedCharacter.data());
+			for (uint32_t i = 0; i < Copy.count; ++i)
+			{
+				FontCharacterTable.StorePacked(Copy.first_index + i, CopiedCharacter.data());
+			}
+		}
+	}
+	// The cache also keeps what was decoded when the serial pass has to run, as that only decodes the rest again.
+	if (Cache)
+	{
+		for (TaskResult &Result : Results)
+		{
+			for (const GlyphKey &Key : Result.Hits)
+			{
+				Cache->Keep(Key);
+			}
+			for (auto &[Key, Packed] : Result.Misses)
+			{
+				Cache->Insert(Key, std::move(Packed));
+			}
+		}
+	}
+	cache_updated = (Cache != nullptr);
+	if (!clean)
+	{
+		// Kept for the serial pass, which stores these characters again instead of decoding them.
+		Decoded.assign(Font.FontCharacterTable.GetCount(), false);
+		for (const TaskResult &Result : Results)
+		{
+			for (uint32_t index : Result.Decoded)
+			{
+				Decoded[index] = true;
+			}
+		}
+		std::swap(DecodedCharacters, Font.FontCharacterTable);
+	}
+	DeferredCharacters.clear();
+	DeferredLines.clear();
+	DeferredCopies.clear();
+	return clean;
+}
+
+// Whether the last DecodeDeferredCharacters() left the GlyphCache with the entries to save.
+bool MisbitFontAssembler::Parser::IsCacheUpdated() const
+{
+	return cache_updated;
+}
+
+bool MisbitFontAssembler::Parser::IsDrawLine(std::string_view line)
+{
+	// Most lines are pixel rows, which can be ruled out by their first character without tokenizing them.
+	size_t start = line.find_first_not_of(std::string_view(" \t\r\v\f\0", 6));
+	if (start == std::string_view::npos || (line[start] != 'd' && line[start] != 'D'))
+	{
+		return false;
+	}
+	LineLexer.Reset(line);
+	Lexeme lexeme;
+	if (!LineLexer.Next(lexeme) || lexeme.type != LexemeType::Word)
+	{
+		return false;
+	}
+	const TokenType *keyword = TokenList.Find(lexeme.text);
+	return keyword && *keyword == TokenType::Draw;
+}
+
+// Decodes a single character on its own, failing if it produced a diagnostic or was turned off by something other than its closing DRAW line.
+bool MisbitFontAssembler::Parser::DecodeDeferredCharacter(const FontSettings &Settings, const DeferredCharacter &Character, const std::string_view *lines)
+{
+	Font.Settings.palette_format = Settings.palette_format;
+	Font.Settings.max_font_size = Settings.max_font_size;
+	Font.Settings.spacing_type = Settings.spacing_type;
+	current_draw_mode = Character.draw_mode;
+	current_font_width = Character.width;
+	BeginCharacter();
+	current_line_number = Character.first_line_number;
+	for (size_t i = 0; i < Character.line_count; ++i)
+	{
+		ParseLine(lines[Character.first_line + i]);
+		if (!draw)
+		{
+			return false;
+		}
+	}
+	draw = false;
+	return SourceDiagnostics->GetErrorCount() == 0 && SourceDiagnostics->GetWarningCount() == 0;
+}
+
+bool MisbitFontAssembler::Parser::DecodePixelRow(std::string_view line)
+{
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	if (current_draw_coordinates.y >= max_font_size.height)
+	{
+		return false;
+	}
+	uint8_t *row = &CurrentFontCharacter.character[current_draw_coordinates.y * max_font_size.width];
+	size_t pixel_count = 0;
+	if (!PixelRowDecoder.Decode(line, row, GetCharacterFontWidth(), pixel_count))
+	{
+		return false;
+	}
+	current_draw_coordinates.x = 0;
+	++current_draw_coordinates.y;
+	return true;
+}
+
+void MisbitFontAssembler::Parser::ParseCommand(const Lexeme &lexeme)
+{
+	const TokenType *keyword = (lexeme.type == LexemeType::Word) ? TokenList.Find(lexeme.text) : nullptr;
+	if (!keyword)
+	{
+		Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+		return;
+	}
+	if (Stats)
+	{
+		Stats->Count(Counter::Directives);
+	}
+	// Anything beyond drawing keeps the include it is in from being replayed.
+	if (*keyword != TokenType::Draw && *keyword != TokenType::DrawMode && *keyword != TokenType::CurrentFontWidth)
+	{
+		++setting_directive_count;
+	}
+	token_type = *keyword;
+	keyword_column = lexeme.column;
+}
+
+void MisbitFontAssembler::Parser::ParseOperand(const Lexeme &lexeme)
+{
+	if (token_type == TokenType::ImportSheet)
+	{
+		ParseSheetOperand(lexeme);
+		return;
+	}
+	operand_seen = true;
+	FontSettings &Settings = Font.Settings;
+	switch (token_type)
+	{
+		case TokenType::FontName:
+		case TokenType::Include:
+		case TokenType::Language:
+		{
+			if (lexeme.type == LexemeType::Word)
+			{
+				Error(lexeme.column, ErrorType::StringRequirement, lexeme.text);
+				return;
+			}
+			else if (lexeme.type == LexemeType::UnterminatedString)
+			{
+				Error(lexeme.column, ErrorType::UnterminatedString, lexeme.text);
+				return;
+			}
+			if (token_type == TokenType::Include)
+			{
+				// Parsed once the rest of the line has been checked.
+				pending_include = lexeme.text;
+				pending_include_column = lexeme.column;
+			}
+			else if (token_type == TokenType::FontName)
+			{
+				if (lexeme.text.size() > 64)
+				{
+					Warning(lexeme.column, WarningType::FontNameTruncated);
+				}
+				Settings.font_name = lexeme.text;
+			}
+			else
+			{
+				if (lexeme.text.size() > 64)
+				{
+					Warning(lexeme.column, WarningType::LanguageTruncated);
+				}
+				Settings.language = lexeme.text;
+			}
+			return;
+		}
+		default:
+		{
+			if (lexeme.type != LexemeType::Word)
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				return;
+			}
+			break;
+		}
+	}
+	switch (token_type)
+	{
+		case TokenType::CopyGlyph:
+		case TokenType::RepeatGlyph:
+		{
+			uint32_t value = 0;
+			// Copies are reserved up front, so the count is capped before anything is allocated for them.
+			if (!ParseNumber(lexeme.text, NumberFormat::Decimal | NumberFormat::Hexadecimal, value) || (token_type == TokenType::RepeatGlyph && (value == 0 || value > MaxRepeatCount || !Font.FontCharacterTable.HasRoom(value))))
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				break;
+			}
+			uint32_t count = Font.FontCharacterTable.GetCount();
+			if (token_type == TokenType::CopyGlyph)
+			{
+				CopyCharacter(lexeme.column, value, 1);
+			}
+			else if (count == 0)
+			{
+				Error(keyword_column, ErrorType::UndrawnCharacter);
+			}
+			else
+			{
+				CopyCharacter(lexeme.column, count - 1, value);
+			}
+			break;
+		}
+		case TokenType::CurrentFontWidth:
+		{
+			uint16_t current_font_width = 0;
+			if (!ParseNumber(lexeme.text, NumberFormat::Decimal | NumberFormat::Hexadecimal, current_font_width))
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				break;
+			}
+			if (Settings.spacing_type == SpacingType::Variable)
+			{
+				if (current_font_width > Settings.max_font_size.width)
+				{
+					Warning(lexeme.column, WarningType::CurrentFontWidthTooLarge);
+				}
+				else
+				{
+					this->current_font_width = current_font_width;
+				}
+			}
+			else
+			{
+				Warning(lexeme.column, WarningType::CurrentFontWidthMonospace);
+			}
+			break;
+		}
+		case TokenType::Draw:
+		{
+			const bool *toggle = ToggleList.Find(lexeme.text);
+			if (!toggle)
+			{
+				Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+			}
+			else if (*toggle == draw)
+			{
+				Warning(lexeme.column, draw ? WarningType::DrawingAlreadyOn : WarningType::DrawingAlreadyOff);
+			}
+			else if (*toggle)
+			{
+				BeginCharacter();
+			}
+			else
+			{
+				EndCharacter(lexeme.column);
+			}
+			break;
+		}
+		case TokenType::DrawMode:
+		{
+			const DrawMode *draw_mode = DrawModeList.Find(lexeme.text);
+			if (!draw_mode)
+			{
+				Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+				break;
+			}
+			current_draw_mode = *draw_mode;
+			break;
+		}
+		case TokenType::MaxFontSize:
+		{
+			FontSizeData size = { 0, 0 };
+			size_t separator = lexeme.text.find('x');
+			if (separator == std::string_view::npos || !ParseNumber(lexeme.text.substr(0, separator), NumberFormat::Decimal, size.width) || !ParseNumber(lexeme.text.substr(separator + 1), NumberFormat::Decimal, size.height))
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				break;
+			}
+			if (size.width < 1 || size.width > 256 || size.height < 1 || size.height > 256)
+			{
+				Error(lexeme.column, ErrorType::UnsupportedMaxFontSize, lexeme.text);
+				break;
+			}
+			if (Font.FontCharacterTable.GetCount() == 0)
+			{
+				Settings.max_font_size = size;
+			}
+			else
+			{
+				Warning(lexeme.column, WarningType::MaxFontSizeLocked);
+			}
+			break;
+		}
+		case TokenType::PaletteFormat:
+		{
+			uint8_t palette_format = 0;
+			if (!ParseNumber(lexeme.text, NumberFormat::Decimal, palette_format))
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				break;
+			}
+			if (Font.FontCharacterTable.GetCount() == 0)
+			{
+				if (palette_format >= 1 && palette_format <= 8)
+				{
+					SourceDiagnostics->Message(fmt::format("Setting Palette Format to {}.", palette_format));
+					Settings.palette_format = palette_format;
+				}
+				else
+				{
+					Error(lexeme.column, ErrorType::UnsupportedPaletteFormat, lexeme.text);
+				}
+			}
+			else
+			{
+				Warning(lexeme.column, WarningType::PaletteFormatLocked);
+			}
+			break;
+		}
+		case TokenType::SpacingType:
+		{
+			if (Font.FontCharacterTable.GetCount() == 0)
+			{
+				const SpacingType *spacing_type = SpacingTypeList.Find(lexeme.text);
+				if (!spacing_type)
+				{
+					Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+					break;
+				}
+				Settings.spacing_type = *spacing_type;
+			}
+			else
+			{
+				Warning(lexeme.column, WarningType::SpacingTypeLocked);
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+void MisbitFontAssembler::Parser::ParseDrawToken(const Lexeme &lexeme)
+{
+	if (lexeme.type == LexemeType::Word && IsPixelWord(lexeme.text))
+	{
+		DrawPixelWord(lexeme);
+		row_drawn = true;
+		return;
+	}
+	const TokenType *keyword = (lexeme.type == LexemeType::Word) ? TokenList.Find(lexeme.text) : nullptr;
+	if (!keyword)
+	{
+		Error(lexeme.column, ErrorType::InvalidToken, lexeme.text);
+		return;
+	}
+	else if (*keyword != TokenType::Draw)
+	{
+		Error(lexeme.column, ErrorType::IllegalToken, lexeme.text);
+		return;
+	}
+	if (Stats)
+	{
+		Stats->Count(Counter::Directives);
+	}
+	token_type = TokenType::Draw;
+	keyword_column = lexeme.column;
+}
+
+// A path written in the source, which is relative to the file being parsed.
+std::filesystem::path MisbitFontAssembler::Parser::ResolvePath(const std::string &path) const
+{
+	std::filesystem::path resolved_path(path);
+	if (resolved_path.is_relative() && !IncludeStack.empty())
+	{
+		resolved_path = std::filesystem::path(IncludeStack.back()).parent_path() / resolved_path;
+	}
+	return resolved_path;
+}
+
+// Parses the file named by the include directive on the line just parsed, unless it was already included.
+void MisbitFontAssembler::Parser::ParseInclude(size_t column)
+{
+	std::string include_path = std::move(pending_include);
+	if (!file_access)
+	{
+		Error(column, ErrorType::FileAccessDisabled, include_path);
+		return;
+	}
+	std::filesystem::path path = ResolvePath(include_path);
+	std::error_code error;
+	std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error);
+	std::string key = (error ? path : canonical_path).string();
+	if (std::find(IncludeStack.begin(), IncludeStack.end(), key) != IncludeStack.end())
+	{
+		Error(column, ErrorType::IncludeCycle, include_path);
+		return;
+	}
+	if (IncludedFiles.find(key) != IncludedFiles.end())
+	{
+		return;
+	}
+	uint64_t file_size = std::filesystem::file_size(path, error);
+	int64_t file_time = error ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+	const FontSettings &Settings = Font.Settings;
+	std::string cache_key = fmt::format("{}\n{} {}x{} {} {} {}", key, Settings.palette_format, Settings.max_font_size.width, Settings.max_font_size.height, static_cast<int>(Settings.spacing_type), static_cast<int>(current_draw_mode), current_font_width);
+	std::shared_ptr<const IncludedBlock> Block = (Includes && !error) ? Includes->Find(cache_key, file_size, file_time) : nullptr;
+	if (Block && Font.FontCharacterTable.HasRoom(Block->count))
+	{
+		IncludedFiles.insert(key);
+		ReplayInclude(*Block);
+		return;
+	}
+	std::unique_ptr<InputReader> IncludeReader = std::make_unique<InputReader>();
+	if (!IncludeReader->Open(path.string()))
+	{
+		Error(column, ErrorType::IncludeFailed, include_path);
+		return;
+	}
+	unmapped_include = unmapped_include || !IncludeReader->IsMapped();
+	IncludedFiles.insert(key);
+	size_t line_number = current_line_number;
+	uint32_t first_index = Font.FontCharacterTable.GetCount();
+	size_t diagnostic_count = SourceDiagnostics->GetErrorCount() + SourceDiagnostics->GetWarningCount();
+	size_t directive_count = setting_directive_count;
+	IncludeStack.push_back(key);
+	IncludeNames.push_back(include_path);
+	SourceDiagnostics->SetIncludedFile(include_path);
+	current_line_number = 1;
+	std::string_view line;
+	while (IncludeReader->NextLine(line))
+	{
+		ParseLine(line);
+	}
+	IncludedSources.push_back(std::move(IncludeReader));
+	IncludeStack.pop_back();
+	IncludeNames.pop_back();
+	SourceDiagnostics->SetIncludedFile(IncludeNames.empty() ? "" : IncludeNames.back());
+	current_line_number = line_number;
+	// Only characters packed in place can be copied out, and only an include that drew nothing but characters can be replayed.
+	bool replayable = !deferred && !Stream && !draw && setting_directive_count == directive_count && SourceDiagnostics->GetErrorCount() + SourceDiagnostics->GetWarningCount() == diagnostic_count;
+	if (Includes && !error && replayable)
+	{
+		const GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+		std::shared_ptr<IncludedBlock> NewBlock = std::make_shared<IncludedBlock>();
+		size_t packed_size = (FontCharacterTable.GetCharacterBits() + 7) / 8;
+		NewBlock->count = FontCharacterTable.GetCount() - first_index;
+		NewBlock->Packed.resize(NewBlock->count * packed_size);
+		for (uint32_t i = 0; i < NewBlock->count; ++i)
+		{
+			FontCharacterTable.CopyPacked(first_index + i, NewBlock->Packed.data() + (i * packed_size));
+		}
+		if (Settings.spacing_type == SpacingType::Variable)
+		{
+			NewBlock->Widths.assign(FontCharacterTable.GetVariableTable() + first_index, FontCharacterTable.GetVariableTable() + first_index + NewBlock->count);
+		}
+		NewBlock->file_size = file_size;
+		NewBlock->file_time = file_time;
+		NewBlock->draw_mode = current_draw_mode;
+		NewBlock->current_font_width = current_font_width;
+		Includes->Insert(cache_key, std::move(NewBlock));
+	}
+}
+
+// Adds the characters of an include parsed before, leaving the same state behind as parsing it again would.
+void MisbitFontAssembler::Parser::ReplayInclude(const IncludedBlock &Block)
+{
+	GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	if (FontCharacterTable.GetCount() == 0)
+	{
+		FontCharacterTable.Configure(Font.Settings);
+	}
+	size_t packed_size = (FontCharacterTable.GetCharacterBits() + 7) / 8;
+	for (uint32_t i = 0; i < Block.count; ++i)
+	{
+		uint16_t width = Block.Widths.empty() ? 0 : Block.Widths[i] + 1;
+		FontCharacterTable.StorePacked(FontCharacterTable.Reserve(width), Block.Packed.data() + (i * packed_size));
+	}
+	current_draw_mode = Block.draw_mode;
+	current_font_width = Block.current_font_width;
+	if (Stats)
+	{
+		Stats->Count(Counter::Characters, Block.count);
+		Stats->Count(Counter::Pixels, static_cast<size_t>(Font.Settings.max_font_size.width) * Font.Settings.max_font_size.height * Block.count);
+	}
+	if (Stream)
+	{
+		Stream->WriteCharacters(Font);
+	}
+}
+
+// import_sheet takes the sheet's path followed by the number of columns and rows of characters in it.
+void MisbitFontAssembler::Parser::ParseSheetOperand(const Lexeme &lexeme)
+{
+	switch (operand_count++)
+	{
+		case 0:
+		{
+			if (lexeme.type == LexemeType::Word)
+			{
+				Error(lexeme.column, ErrorType::StringRequirement, lexeme.text);
+				break;
+			}
+			else if (lexeme.type == LexemeType::UnterminatedString)
+			{
+				Error(lexeme.column, ErrorType::UnterminatedString, lexeme.text);
+				break;
+			}
+			// Imported once the rest of the line has been checked.
+			pending_sheet = lexeme.text;
+			pending_sheet_column = lexeme.column;
+			break;
+		}
+		default:
+		{
+			uint32_t value = 0;
+			if (lexeme.type != LexemeType::Word || !ParseNumber(lexeme.text, NumberFormat::Decimal | NumberFormat::Hexadecimal, value) || value == 0)
+			{
+				Error(lexeme.column, ErrorType::InvalidValue, lexeme.text);
+				break;
+			}
+			(operand_count == 2 ? sheet_columns : sheet_rows) = value;
+			operand_seen = (operand_count == 3);
+			break;
+		}
+	}
+}
+
+// Appends the cells of the sheet named by the import_sheet directive on the line just parsed, left to right and
+// top to bottom.  Each row of cells is quantized in one pass over its rows of pixels, then packed.
+void MisbitFontAssembler::Parser::ImportSheet(size_t column)
+{
+	std::string sheet_path = std::move(pending_sheet);
+	if (!file_access)
+	{
+		Error(column, ErrorType::FileAccessDisabled, sheet_path);
+		return;
+	}
+	switch (Sheet.Open(ResolvePath(sheet_path).string()))
+	{
+		case SheetReadResult::Success:
+		{
+			break;
+		}
+		case SheetReadResult::OpenFailed:
+		{
+			Error(column, ErrorType::ImportFailed, sheet_path);
+			return;
+		}
+		case SheetReadResult::InvalidHeader:
+		{
+			Error(column, ErrorType::InvalidSheet, sheet_path);
+			return;
+		}
+		case SheetReadResult::Truncated:
+		{
+			Error(column, ErrorType::TruncatedSheet, sheet_path);
+			return;
+		}
+	}
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	if (static_cast<uint64_t>(sheet_columns) * max_font_size.width > Sheet.GetWidth() || static_cast<uint64_t>(sheet_rows) * max_font_size.height > Sheet.GetHeight())
+	{
+		Sheet.Close();
+		Error(column, ErrorType::SheetTooSmall, sheet_path);
+		return;
+	}
+	GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	if (!FontCharacterTable.HasRoom(static_cast<uint64_t>(sheet_columns) * sheet_rows))
+	{
+		Sheet.Close();
+		Error(column, ErrorType::TooManyCharacters);
+		return;
+	}
+	if (FontCharacterTable.GetCount() == 0)
+	{
+		FontCharacterTable.Configure(Font.Settings);
+	}
+	// Cells are cut to the current font width like drawn characters, leaving the rest of each cell blank.
+	uint16_t width = (Font.Settings.spacing_type == SpacingType::Variable) ? current_font_width : 0;
+	uint16_t read_width = width ? width : max_font_size.width;
+	size_t character_size = static_cast<size_t>(max_font_size.width) * max_font_size.height;
+	Sheet.SetPaletteFormat(Font.Settings.palette_format);
+	SheetCells.assign(sheet_columns * character_size, 0);
+	for (uint32_t row = 0; row < sheet_rows; ++row)
+	{
+		{
+			PhaseScope DecodeScope(Stats, Phase::Decode);
+			for (uint16_t y = 0; y < max_font_size.height; ++y)
+			{
+				uint32_t sheet_y = (row * max_font_size.height) + y;
+				for (uint32_t cell = 0; cell < sheet_columns; ++cell)
+				{
+					Sheet.ReadRow(sheet_y, cell * max_font_size.width, read_width, &SheetCells[(cell * character_size) + (y * max_font_size.width)]);
+				}
+			}
+		}
+		{
+			PhaseScope PackScope(Stats, Phase::Pack);
+			for (uint32_t cell = 0; cell < sheet_columns; ++cell)
+			{
+				FontCharacterTable.Append(&SheetCells[cell * character_size], width);
+			}
+		}
+		if (Stream)
+		{
+			Stream->WriteCharacters(Font);
+		}
+	}
+	Sheet.Close();
+	if (Stats)
+	{
+		size_t character_count = static_cast<size_t>(sheet_columns) * sheet_rows;
+		Stats->Count(Counter::Characters, character_count);
+		Stats->Count(Counter::Pixels, character_size * character_count);
+	}
+}
+
+// Appends copies of a character already in the arena, copying its packed bytes and width instead of decoding it again.
+void MisbitFontAssembler::Parser::CopyCharacter(size_t column, uint32_t index, uint32_t copies)
+{
+	GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+	if (index >= FontCharacterTable.GetCount())
+	{
+		Error(column, ErrorType::UndrawnCharacter, fmt::format("{}", index));
+		return;
+	}
+	if (!FontCharacterTable.IsHeld(index))
+	{
+		Error(column, ErrorType::StreamedCharacter, fmt::format("{}", index));
+		return;
+	}
+	if (!FontCharacterTable.HasRoom(copies))
+	{
+		Error(column, ErrorType::TooManyCharacters);
+		return;
+	}
+	PhaseScope PackScope(Stats, Phase::Pack);
+	uint16_t width = FontCharacterTable.GetWidth(index);
+	if (deferred)
+	{
+		// Stored by DecodeDeferredCharacters(), once the character being copied has been.
+		DeferredCopies.push_back({ index, FontCharacterTable.GetCount(), copies });
+		for (uint32_t i = 0; i < copies; ++i)
+		{
+			FontCharacterTable.Reserve(width);
+		}
+	}
+	else
+	{
+		CopiedCharacter.resize((FontCharacterTable.GetCharacterBits() + 7) / 8);
+		FontCharacterTable.CopyPacked(index, CopiedCharacter.data());
+		for (uint32_t i = 0; i < copies; ++i)
+		{
+			FontCharacterTable.StorePacked(FontCharacterTable.Reserve(width), CopiedCharacter.data());
+			if (Stream)
+			{
+				Stream->WriteCharacters(Font);
+			}
+		}
+	}
+	if (Stats)
+	{
+		Stats->Count(Counter::Characters, copies);
+		Stats->Count(Counter::Pixels, static_cast<size_t>(Font.Settings.max_font_size.width) * Font.Settings.max_font_size.height * copies);
+	}
+}
+
+bool MisbitFontAssembler::Parser::IsPixelWord(std::string_view word) const
+{
+	if (word[0] >= '0' && word[0] <= '9')
+	{
+		return true;
+	}
+	// Hexadecimal pixels may start with a letter, so require the start of the word to look like one.
+	const std::array<uint8_t, 256> &Digits = DigitTable<DrawMode::Hexadecimal>;
+	return current_draw_mode == DrawMode::Hexadecimal && Digits[static_cast<uint8_t>(word[0])] < 0x10 && (word.size() == 1 || Digits[static_cast<uint8_t>(word[1])] < 0x10);
+}
+
+void MisbitFontAssembler::Parser::DrawPixelWord(const Lexeme &lexeme)
+{
+	PhaseScope DecodeScope(Stats, Phase::Decode);
+	uint8_t pixel_digits = GetPixelDigits(current_draw_mode, Font.Settings.palette_format);
+	for (size_t offset = 0; offset < lexeme.text.size(); offset += pixel_digits)
+	{
+		uint8_t pixel = DecodePixel(lexeme.text.substr(offset, pixel_digits), lexeme.column + offset);
+		DrawPixel(pixel, lexeme.column + offset);
+	}
+}
+
+uint8_t MisbitFontAssembler::Parser::DecodePixel(std::string_view digits, size_t column)
+{
+	uint8_t base = GetBase(current_draw_mode);
+	const std::array<uint8_t, 256> &Digits = GetDigitTable(current_draw_mode);
+	uint32_t value = 0;
+	for (char c : digits)
+	{
+		uint8_t digit = Digits[static_cast<uint8_t>(c)];
+		if (digit >= base)
+		{
+			Warning(column, WarningType::UnsupportedPixelValue);
+			return 0;
+		}
+		value = (value * base) + digit;
+	}
+	uint8_t max_value = (0xFF >> (8 - Font.Settings.palette_format));
+	if (value > max_value)
+	{
+		Warning(column, WarningType::TruncatedPixelValue);
+		value &= max_value;
+	}
+	return static_cast<uint8_t>(value);
+}
+
+void MisbitFontAssembler::Parser::DrawPixel(uint8_t pixel, size_t column)
+{
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	if (current_draw_coordinates.y >= max_font_size.height)
+	{
+		Warning(column, WarningType::OutOfBoundsY);
+		return;
+	}
+	if (current_draw_coordinates.x >= GetCharacterFontWidth())
+	{
+		Warning(column, WarningType::OutOfBoundsX);
+		return;
+	}
+	CurrentFontCharacter.character[(current_draw_coordinates.y * max_font_size.width) + current_draw_coordinates.x] = pixel;
+	++current_draw_coordinates.x;
+}
+
+uint16_t MisbitFontAssembler::Parser::GetCharacterFontWidth() const
+{
+	return (Font.Settings.spacing_type == SpacingType::Variable && CurrentFontCharacter.width) ? CurrentFontCharacter.width : Font.Settings.max_font_size.width;
+}
+
+void MisbitFontAssembler::Parser::BeginCharacter()
+{
+	const FontSizeData &max_font_size = Font.Settings.max_font_size;
+	draw = true;
+	current_draw_coordinates = { 0, 0 };
+	if (Font.FontCharacterTable.GetCount() == 0)
+	{
+		Font.FontCharacterTable.Configure(Font.Settings);
+	}
+	CurrentFontCharacter.width = (Font.Settings.spacing_type == SpacingType::Variable) ? current_font_width : 0;
+	if (deferred)
+	{
+		DeferredCharacters.push_back({ DeferredLines.size(), 0, current_line_number + 1, DeferredCharacter::NoIndex, CurrentFontCharacter.width, current_draw_mode });
+		return;
+	}
+	// Decoded without diagnostics by the deferred pass this one redoes, so its lines are skipped.
+	uint32_t index = Font.FontCharacterTable.GetCount();
+	reused_character = (index < Decoded.size() && Decoded[index]);
+	if (reused_character)
+	{
+		return;
+	}
+	PixelRowDecoder.Configure(current_draw_mode, Font.Settings.palette_format);
+	CurrentFontCharacter.character.assign(max_font_size.width * max_font_size.height, 0);
+}
+
+void MisbitFontAssembler::Parser::EndCharacter(size_t column)
+{
+	bool reused = reused_character;
+	draw = false;
+	reused_character = false;
+	current_draw_coordinates = { 0, 0 };
+	if (deferred)
+	{
+		DeferredCharacters.back().line_count = DeferredLines.size() - DeferredCharacters.back().first_line;
+	}
+	// The character is dropped, and a deferred one is still decoded for its diagnostics but never stored.
+	if (!Font.FontCharacterTable.HasRoom(1))
+	{
+		Error(column, ErrorType::TooManyCharacters);
+		return;
+	}
+	if (deferred)
+	{
+		DeferredCharacter &Character = DeferredCharacters.back();
+		Character.index = Font.FontCharacterTable.Reserve(CurrentFontCharacter.width);
+	}
+	else if (reused)
+	{
+		PhaseScope PackScope(Stats, Phase::Pack);
+		GlyphArena &FontCharacterTable = Font.FontCharacterTable;
+		uint32_t index = FontCharacterTable.Reserve(CurrentFontCharacter.width);
+		CopiedCharacter.resize((FontCharacterTable.GetCharacterBits() + 7) / 8);
+		DecodedCharacters.CopyPacked(index, CopiedCharacter.data());
+		FontCharacterTable.StorePacked(index, CopiedCharacter.data());
+	}
+	else
+	{
+		PhaseScope PackScope(Stats, Phase::Pack);
+		Font.FontCharacterTable.Append(CurrentFontCharacter.character.data(), CurrentFontCharacter.width);
+	}
+	if (Stats)
+	{
+		Stats->Count(Counter::Characters);
+		Stats->Count(Counter::Pixels, static_cast<size_t>(Font.Settings.max_font_size.width) * Font.Settings.max_font_size.height);
+	}
+	if (Stream)
+	{
+		Stream->WriteCharacters(Font);
+	}
+}
+
+void MisbitFontAssembler::Parser::Warning(size_t column, WarningType warning_type)
+{
+	SourceDiagnostics->Warning(current_line_number, column, warning_type, current_draw_mode);
+}
+
+void MisbitFontAssembler::Parser::Error(size_t column, ErrorType error_type, std::string_view token)
+{
+	line_error = true;
+	SourceDiagnostics->Error(current_line_number, column, error_type, token_type, token);
+}
@@ -0,0 +1,308 @@
+#include "../include/row_decoder.hpp"
+#include "../include/pixel_format.hpp"
+#include <cstring>
+#include <array>
+#if defined(__SSE2__) || defined(_M_X64)
+#define MISBITFONT_ASSEMBLER_USE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define MISBITFONT_ASSEMBLER_USE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+	using namespace MisbitFontAssembler;
+
+	constexpr uint8_t Separator = SeparatorDigit;
+
+	size_t CountBits(uint32_t mask)
+	{
+#if defined(__GNUC__)
+		return static_cast<size_t>(__builtin_popcount(mask));
+#else
+		size_t count = 0;
+		for (; mask; mask &= mask - 1)
+		{
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	// Converts each character to its digit value, or Separator for spaces and tabs.  Fails on anything else.
+	template <DrawMode Mode>
+	bool ConvertDigitsScalar(const char *line, size_t length, uint8_t *digits, size_t &separator_count)
+	{
+		const std::array<uint8_t, 256> &Table = DigitTable<Mode>;
+		for (size_t i = 0; i < length; ++i)
+		{
+			uint8_t digit = Table[static_cast<uint8_t>(line[i])];
+			if (digit == InvalidDigit)
+			{
+				return false;
+			}
+			separator_count += (digit == Separator);
+			digits[i] = digit;
+		}
+		return true;
+	}
+
+#ifdef MISBITFONT_ASSEMBLER_USE_SSE2
+	template <uint8_t DecimalLimit, bool Hexadecimal>
+	bool ConvertDigitsSSE2(const char *line, size_t length, uint8_t *digits, size_t &separator_count, size_t &converted)
+	{
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i decimal_max = _mm_set1_epi8(static_cast<char>(DecimalLimit - 1));
+		const __m128i case_bit = _mm_set1_epi8(0x20);
+		const __m128i letter_a = _mm_set1_epi8('a');
+		const __m128i letter_max = _mm_set1_epi8(5);
+		const __m128i ten = _mm_set1_epi8(0xA);
+		size_t i = converted;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+			__m128i is_separator = _mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, tab));
+			__m128i decimal = _mm_sub_epi8(c, zero);
+			__m128i is_decimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, decimal_max), decimal);
+			__m128i value = _mm_and_si128(is_decimal, decimal);
+			__m128i valid = _mm_or_si128(is_separator, is_decimal);
+			if constexpr (Hexadecimal)
+			{
+				__m128i letter = _mm_sub_epi8(_mm_or_si128(c, case_bit), letter_a);
+				__m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, letter_max), letter);
+				value = _mm_or_si128(value, _mm_and_si128(is_letter, _mm_add_epi8(letter, ten)));
+				valid = _mm_or_si128(valid, is_letter);
+			}
+			if (_mm_movemask_epi8(valid) != 0xFFFF)
+			{
+				return false;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(digits + i), _mm_or_si128(value, is_separator));
+			separator_count += CountBits(static_cast<uint32_t>(_mm_movemask_epi8(is_separator)));
+		}
+		converted = i;
+		return true;
+	}
+
+	// Combines pairs of digits (first digit in the low byte of each 16-bit lane) into 8 pixels at a time.
+	template <uint8_t Base>
+	size_t CombineDigitPairsSSE2(const uint8_t *digits, size_t digit_count, uint8_t *pixels, uint16_t &overflow)
+	{
+		const __m128i low_byte = _mm_set1_epi16(0x00FF);
+		const __m128i multiplier = _mm_set1_epi16(Base);
+		__m128i combined_bits = _mm_setzero_si128();
+		size_t i = 0;
+		for (; i + 16 <= digit_count; i += 16)
+		{
+			__m128i pairs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits + i));
+			__m128i pixel = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(pairs, low_byte), multiplier), _mm_srli_epi16(pairs, 8));
+			combined_bits = _mm_or_si128(combined_bits, pixel);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(pixels + (i / 2)), _mm_packus_epi16(pixel, pixel));
+		}
+		alignas(16) uint16_t lanes[8];
+		_mm_store_si128(reinterpret_cast<__m128i *>(lanes), combined_bits);
+		for (uint16_t lane : lanes)
+		{
+			overflow |= lane;
+		}
+		return i;
+	}
+#endif
+
+#ifdef MISBITFONT_ASSEMBLER_USE_AVX2
+	template <uint8_t DecimalLimit, bool Hexadecimal>
+	__attribute__((target("avx2"))) bool ConvertDigitsAVX2(const char *line, size_t length, uint8_t *digits, size_t &separator_count, size_t &converted)
+	{
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i zero = _mm256_set1_epi8('0');
+		const __m256i decimal_max = _mm256_set1_epi8(static_cast<char>(DecimalLimit - 1));
+		const __m256i case_bit = _mm256_set1_epi8(0x20);
+		const __m256i letter_a = _mm256_set1_epi8('a');
+		const __m256i letter_max = _mm256_set1_epi8(5);
+		const __m256i ten = _mm256_set1_epi8(0xA);
+		size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line + i));
+			__m256i is_separator = _mm256_or_si256(_mm256_cmpeq_epi8(c, space), _mm256_cmpeq_epi8(c, tab));
+			__m256i decimal = _mm256_sub_epi8(c, zero);
+			__m256i is_decimal = _mm256_cmpeq_epi8(_mm256_min_epu8(decimal, decimal_max), decimal);
+			__m256i value = _mm256_and_si256(is_decimal, decimal);
+			__m256i valid = _mm256_or_si256(is_separator, is_decimal);
+			if constexpr (Hexadecimal)
+			{
+				__m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, case_bit), letter_a);
+				__m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, letter_max), letter);
+				value = _mm256_or_si256(value, _mm256_and_si256(is_letter, _mm256_add_epi8(letter, ten)));
+				valid = _mm256_or_si256(valid, is_letter);
+			}
+			if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFF)
+			{
+				return false;
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(digits + i), _mm256_or_si256(value, is_separator));
+			separator_count += CountBits(static_cast<uint32_t>(_mm256_movemask_epi8(is_separator)));
+		}
+		converted = i;
+		return true;
+	}
+
+	const bool HasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+MisbitFontAssembler::RowDecoder::RowDecoder() : Decoder(&RowDecoder::DecodeRow<DrawMode::Binary, 1>)
+{
+}
+
+template <MisbitFontAssembler::DrawMode Mode, size_t... Formats>
+constexpr std::array<MisbitFontAssembler::RowDecoder::DecodeFunction, 8> MisbitFontAssembler::RowDecoder::GetDecoders(std::index_sequence<Formats...>)
+{
+	return { &RowDecoder::DecodeRow<Mode, static_cast<uint8_t>(Formats + 1)>... };
+}
+
+void MisbitFontAssembler::RowDecoder::Configure(DrawMode draw_mode, uint8_t palette_format)
+{
+	static constexpr std::array<std::array<DecodeFunction, 8>, 4> Decoders = {
+		GetDecoders<DrawMode::Binary>(std::make_index_sequence<8>()),
+		GetDecoders<DrawMode::Octal>(std::make_index_sequence<8>()),
+		GetDecoders<DrawMode::Decimal>(std::make_index_sequence<8>()),
+		GetDecoders<DrawMode::Hexadecimal>(std::make_index_sequence<8>())
+	};
+	Decoder = Decoders[static_cast<size_t>(draw_mode)][palette_format - 1];
+}
+
+bool MisbitFontAssembler::RowDecoder::Decode(std::string_view line, uint8_t *pixels, size_t max_pixels, size_t &pixel_count)
+{
+	return (this->*Decoder)(line, pixels, max_pixels, pixel_count);
+}
+
+template <MisbitFontAssembler::DrawMode Mode, uint8_t Bits>
+bool MisbitFontAssembler::RowDecoder::DecodeRow(std::string_view line, uint8_t *pixels, size_t max_pixels, size_t &pixel_count)
+{
+	constexpr uint8_t PixelDigits = GetPixelDigits(Mode, Bits);
+	size_t separator_count = 0;
+	if (line.empty() || !ConvertDigits<Mode>(line, separator_count))
+	{
+		return false;
+	}
+	size_t digit_count = line.size();
+	if (separator_count > 0 && !CompactDigits<PixelDigits>(digit_count))
+	{
+		return false;
+	}
+	if (digit_count == 0 || digit_count % PixelDigits != 0)
+	{
+		return false;
+	}
+	pixel_count = digit_count / PixelDigits;
+	if (pixel_count > max_pixels)
+	{
+		return false;
+	}
+	if (!CombineDigits<Mode, Bits>(digit_count, pixels))
+	{
+		memset(pixels, 0, pixel_count);
+		return false;
+	}
+	return true;
+}
+
+template <MisbitFontAssembler::DrawMode Mode>
+bool MisbitFontAssembler::RowDecoder::ConvertDigits(std::string_view line, size_t &separator_count)
+{
+	constexpr uint8_t DecimalLimit = (GetBase(Mode) < 10) ? GetBase(Mode) : 10;
+	constexpr bool Hexadecimal = (Mode == DrawMode::Hexadecimal);
+	if (Digits.size() < line.size())
+	{
+		Digits.resize(line.size());
+	}
+	size_t converted = 0;
+#ifdef MISBITFONT_ASSEMBLER_USE_AVX2
+	if (HasAVX2 && !ConvertDigitsAVX2<DecimalLimit, Hexadecimal>(line.data(), line.size(), Digits.data(), separator_count, converted))
+	{
+		return false;
+	}
+#endif
+#ifdef MISBITFONT_ASSEMBLER_USE_SSE2
+	if (!ConvertDigitsSSE2<DecimalLimit, Hexadecimal>(line.data(), line.size(), Digits.data(), separator_count, converted))
+	{
+		return false;
+	}
+#endif
+	return ConvertDigitsScalar<Mode>(line.data() + converted, line.size() - converted, Digits.data() + converted, separator_count);
+}
+
+template <uint8_t PixelDigits>
+bool MisbitFontAssembler::RowDecoder::CompactDigits(size_t &digit_count)
+{
+	// Every word has to be made of whole pixels, otherwise the scalar path decodes the partial pixel.
+	size_t write = 0;
+	size_t word_length = 0;
+	for (size_t read = 0; read < digit_count; ++read)
+	{
+		if (Digits[read] == Separator)
+		{
+			if (word_length % PixelDigits != 0)
+			{
+				return false;
+			}
+			word_length = 0;
+			continue;
+		}
+		Digits[write++] = Digits[read];
+		++word_length;
+	}
+	digit_count = write;
+	return true;
+}
+
+template <MisbitFontAssembler::DrawMode Mode, uint8_t Bits>
+bool MisbitFontAssembler::RowDecoder::CombineDigits(size_t digit_count, uint8_t *pixels)
+{
+	constexpr uint8_t Base = GetBase(Mode);
+	constexpr uint8_t PixelDigits = GetPixelDigits(Mode, Bits);
+	constexpr uint16_t MaxValue = static_cast<uint16_t>(0xFF >> (8 - Bits));
+	uint16_t overflow = 0;
+	size_t i = 0;
+	if constexpr (PixelDigits == 1)
+	{
+		for (; i < digit_count; ++i)
+		{
+			overflow |= Digits[i];
+		}
+		memcpy(pixels, Digits.data(), digit_count);
+	}
+	else if constexpr (PixelDigits == 2)
+	{
+#ifdef MISBITFONT_ASSEMBLER_USE_SSE2
+		i = CombineDigitPairsSSE2<Base>(Digits.data(), digit_count, pixels, overflow);
+#endif
+		for (; i < digit_count; i += 2)
+		{
+			uint16_t pixel = (Digits[i] * Base) + Digits[i + 1];
+			overflow |= pixel;
+			pixels[i / 2] = static_cast<uint8_t>(pixel);
+		}
+	}
+	else
+	{
+		for (size_t p = 0; i < digit_count; ++p)
+		{
+			uint16_t pixel = 0;
+			for (uint8_t d = 0; d < PixelDigits; ++d, ++i)
+			{
+				pixel = (pixel * Base) + Digits[i];
+			}
+			overflow |= pixel;
+			pixels[p] = static_cast<uint8_t>(pixel);
+		}
+	}
+	// MaxValue is always 2^n - 1, so any bit outside of it means a value needing a truncation warning.
+	return (overflow & ~MaxValue) == 0;
+}
@@ -0,0 +1,148 @@
+#include "../include/sheet_reader.hpp"
+
+namespace
+{
+	bool IsSpace(uint8_t c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	// Reads one header value, skipping the whitespace and comments before it.
+	bool ReadHeaderValue(const uint8_t *data, size_t size, size_t &position, uint32_t &value)
+	{
+		while (position < size && (IsSpace(data[position]) || data[position] == '#'))
+		{
+			if (data[position] == '#')
+			{
+				while (position < size && data[position] != '\n')
+				{
+					++position;
+				}
+			}
+			else
+			{
+				++position;
+			}
+		}
+		uint64_t result = 0;
+		size_t start = position;
+		while (position < size && data[position] >= '0' && data[position] <= '9' && result <= 0xFFFFFFFF)
+		{
+			result = (result * 10) + (data[position++] - '0');
+		}
+		value = static_cast<uint32_t>(result);
+		return position > start && result <= 0xFFFFFFFF;
+	}
+}
+
+MisbitFontAssembler::SheetReader::SheetReader() : raster(nullptr), row_size(0), width(0), height(0), max_value(1), bitmap(true)
+{
+}
+
+MisbitFontAssembler::SheetReader::~SheetReader()
+{
+	Close();
+}
+
+MisbitFontAssembler::SheetReadResult MisbitFontAssembler::SheetReader::Open(const std::string &path)
+{
+	Close();
+	if (!File.Open(path))
+	{
+		return SheetReadResult::OpenFailed;
+	}
+	const uint8_t *data = File.GetData();
+	size_t size = File.GetSize();
+	if (size < 2 || data[0] != 'P' || (data[1] != '4' && data[1] != '5'))
+	{
+		return SheetReadResult::InvalidHeader;
+	}
+	bitmap = (data[1] == '4');
+	size_t position = 2;
+	max_value = 1;
+	if (!ReadHeaderValue(data, size, position, width) || !ReadHeaderValue(data, size, position, height) || (!bitmap && !ReadHeaderValue(data, size, position, max_value)))
+	{
+		return SheetReadResult::InvalidHeader;
+	}
+	// A single whitespace character separates the header from the raster.
+	if (width == 0 || height == 0 || max_value == 0 || max_value > 0xFFFF || position >= size || !IsSpace(data[position]))
+	{
+		return SheetReadResult::InvalidHeader;
+	}
+	++position;
+	row_size = bitmap ? (static_cast<size_t>(width) + 7) / 8 : static_cast<size_t>(width) * ((max_value > 0xFF) ? 2 : 1);
+	if ((size - position) / row_size < height)
+	{
+		return SheetReadResult::Truncated;
+	}
+	raster = data + position;
+	return SheetReadResult::Success;
+}
+
+void MisbitFontAssembler::SheetReader::Close()
+{
+	File.Close();
+	raster = nullptr;
+	row_size = 0;
+	width = 0;
+	height = 0;
+}
+
+uint32_t MisbitFontAssembler::SheetReader::GetWidth() const
+{
+	return width;
+}
+
+uint32_t MisbitFontAssembler::SheetReader::GetHeight() const
+{
+	return height;
+}
+
+void MisbitFontAssembler::SheetReader::SetPaletteFormat(uint8_t palette_format)
+{
+	uint32_t max_level = 0xFFu >> (8 - palette_format);
+	if (bitmap)
+	{
+		// A set bit is black.
+		Levels.assign(0x100, 0);
+		Levels[1] = static_cast<uint8_t>(max_level);
+		return;
+	}
+	// Ink is dark, as with PBM: black becomes the highest value and white 0.  Samples above the maximum
+	// value (which a valid image does not have) are treated as the maximum.
+	Levels.assign((max_value > 0xFF) ? 0x10000 : 0x100, 0);
+	for (uint32_t value = 0; value < max_value; ++value)
+	{
+		Levels[value] = static_cast<uint8_t>((((max_value - value) * max_level) + (max_value / 2)) / max_value);
+	}
+}
+
+// Quantizes count pixels of row y, starting at column x, into one byte per pixel.
+void MisbitFontAssembler::SheetReader::ReadRow(uint32_t y, uint32_t x, uint32_t count, uint8_t *pixels) const
+{
+	const uint8_t *row = raster + (y * row_size);
+	if (bitmap)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t column = x + i;
+			pixels[i] = Levels[(row[column / 8] >> (7 - (column % 8))) & 0x01];
+		}
+	}
+	else if (max_value > 0xFF)
+	{
+		const uint8_t *samples = row + (static_cast<size_t>(x) * 2);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			pixels[i] = Levels[(samples[i * 2] << 8) | samples[(i * 2) + 1]];
+		}
+	}
+	else
+	{
+		const uint8_t *samples = row + x;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			pixels[i] = Levels[samples[i]];
+		}
+	}
+}
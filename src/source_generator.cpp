@@ -0,0 +1,81 @@
+#include "../include/source_generator.hpp"
+#include "../include/pixel_format.hpp"
+#include <fmt/core.h>
+
+MisbitFontAssembler::SourceGenerator::SourceGenerator(uint64_t seed) : state(seed ? seed : 1)
+{
+}
+
+void MisbitFontAssembler::SourceGenerator::Generate(const SourceConfig &Config, size_t target_size, GeneratedSource &Source)
+{
+	const FontSizeData &max_font_size = Config.max_font_size;
+	uint8_t base = GetBase(Config.draw_mode);
+	uint8_t pixel_digits = GetPixelDigits(Config.draw_mode, Config.palette_format);
+	uint8_t max_value = static_cast<uint8_t>(0xFF >> (8 - Config.palette_format));
+	bool variable = (Config.spacing_type == SpacingType::Variable);
+	std::string &text = Source.text;
+	text.clear();
+	text.reserve(target_size + (static_cast<size_t>(max_font_size.width) * max_font_size.height * (pixel_digits + 1)));
+	text += fmt::format("; palette_format {}, {}, {}, {}x{}\n", Config.palette_format, GetDrawModeName(Config.draw_mode), variable ? "variable" : "monospace", max_font_size.width, max_font_size.height);
+	text += fmt::format("palette_format {}\n", Config.palette_format);
+	text += fmt::format("max_font_size {}x{}\n", max_font_size.width, max_font_size.height);
+	text += fmt::format("draw_mode {}\n", GetDrawModeName(Config.draw_mode));
+	text += fmt::format("spacing_type {}\n", variable ? "variable" : "monospace");
+	text += "font_name \"Benchmark\"\n";
+	text += "language \"Neutral\"\n";
+	Source.line_count = 7;
+	Source.character_count = 0;
+	Source.pixel_count = 0;
+	do
+	{
+		uint16_t width = max_font_size.width;
+		if (variable)
+		{
+			width = static_cast<uint16_t>((Next() % max_font_size.width) + 1);
+			text += fmt::format("current_font_width {}\n", width);
+			++Source.line_count;
+		}
+		text += "draw on\n";
+		for (uint16_t y = 0; y < max_font_size.height; ++y)
+		{
+			bool spaced = (y % 4) == 1;
+			for (uint16_t x = 0; x < width; ++x)
+			{
+				if (spaced && x != 0)
+				{
+					text += ' ';
+				}
+				AppendPixel(text, static_cast<uint8_t>(Next() & max_value), base, pixel_digits);
+			}
+			if ((y % 8) == 7)
+			{
+				text += " ; row";
+			}
+			text += '\n';
+		}
+		text += "draw off\n";
+		Source.line_count += max_font_size.height + 2;
+		Source.pixel_count += static_cast<size_t>(width) * max_font_size.height;
+		++Source.character_count;
+	} while (text.size() < target_size);
+}
+
+// xorshift64
+uint64_t MisbitFontAssembler::SourceGenerator::Next()
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+void MisbitFontAssembler::SourceGenerator::AppendPixel(std::string &text, uint8_t pixel, uint8_t base, uint8_t pixel_digits)
+{
+	char digits[8];
+	for (uint8_t d = pixel_digits; d > 0; --d)
+	{
+		digits[d - 1] = "0123456789ABCDEF"[pixel % base];
+		pixel /= base;
+	}
+	text.append(digits, pixel_digits);
+}
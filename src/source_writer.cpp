@@ -0,0 +1,191 @@
+#include "../include/source_writer.hpp"
+#include "../include/pixel_format.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fmt/core.h>
+
+MisbitFontAssembler::SourceWriter::SourceWriter(DrawMode draw_mode) : file(nullptr), buffer_size(0), PixelText {}, draw_mode(draw_mode), pixel_digits(1), current_font_width(0), inexact_count(0), good(true)
+{
+}
+
+MisbitFontAssembler::SourceWriter::~SourceWriter()
+{
+	if (file)
+	{
+		std::fclose(file);
+	}
+}
+
+bool MisbitFontAssembler::SourceWriter::Write(const FontReader &Font, const std::string &path, std::string_view comment)
+{
+	const FontSettings &Settings = Font.GetSettings();
+	file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+	Buffer.resize(BufferSize);
+	buffer_size = 0;
+	current_font_width = 0;
+	inexact_count = 0;
+	good = true;
+	// Every pixel value is written with the fixed number of digits the row decoder reads for it, so no separators are needed.
+	uint8_t base = GetBase(draw_mode);
+	pixel_digits = GetPixelDigits(draw_mode, Settings.palette_format);
+	for (size_t value = 0; value < PixelText.size(); ++value)
+	{
+		size_t remainder = value;
+		for (uint8_t d = pixel_digits; d > 0; --d)
+		{
+			PixelText[value][d - 1] = "0123456789ABCDEF"[remainder % base];
+			remainder /= base;
+		}
+	}
+	Pixels.resize((Font.GetCharacterBits() / Settings.palette_format) + 8);
+	if (!comment.empty())
+	{
+		Append(fmt::format("; {}\n\n", comment));
+	}
+	Append(fmt::format("palette_format {}\n", Settings.palette_format));
+	Append(fmt::format("max_font_size {}x{}\n", Settings.max_font_size.width, Settings.max_font_size.height));
+	Append(fmt::format("spacing_type {}\n", (Settings.spacing_type == SpacingType::Variable) ? "variable" : "monospace"));
+	Append(fmt::format("draw_mode {}\n", GetDrawModeName(draw_mode)));
+	WriteString("font_name", Settings.font_name);
+	WriteString("language", Settings.language);
+	Append("\n");
+	for (uint32_t i = 0; i < Font.GetCount(); ++i)
+	{
+		WriteCharacter(Font, i);
+	}
+	Flush();
+	bool closed = (std::fclose(file) == 0);
+	file = nullptr;
+	return good && closed;
+}
+
+size_t MisbitFontAssembler::SourceWriter::GetInexactCount() const
+{
+	return inexact_count;
+}
+
+void MisbitFontAssembler::SourceWriter::WriteCharacter(const FontReader &Font, uint32_t index)
+{
+	const FontSettings &Settings = Font.GetSettings();
+	const FontSizeData &max_font_size = Settings.max_font_size;
+	Font.UnpackCharacter(index, Pixels.data());
+	uint16_t draw_width = max_font_size.width;
+	bool exact = true;
+	bool width_changed = false;
+	if (Settings.spacing_type == SpacingType::Variable)
+	{
+		uint16_t width = Font.GetWidth(index);
+		bool wide = false;
+		for (uint16_t y = 0; y < max_font_size.height && !wide; ++y)
+		{
+			const uint8_t *row = &Pixels[y * max_font_size.width];
+			wide = std::any_of(row + std::min(width, max_font_size.width), row + max_font_size.width, [](uint8_t pixel) { return pixel != 0; });
+		}
+		// A width of 0 draws at the maximum font width but records a width of 1.
+		uint16_t font_width = width;
+		if (width == 1 && wide)
+		{
+			font_width = 0;
+		}
+		else if (width > max_font_size.width || wide)
+		{
+			exact = false;
+		}
+		if (font_width <= max_font_size.width && font_width != current_font_width)
+		{
+			current_font_width = font_width;
+			width_changed = true;
+		}
+		draw_width = current_font_width ? current_font_width : max_font_size.width;
+	}
+	if (!exact)
+	{
+		++inexact_count;
+	}
+	// Room for the directives, and for every row with the 8 bytes each pixel copy may write.  Even a 256x256 character fits the buffer.
+	size_t row_size = (static_cast<size_t>(draw_width) * pixel_digits) + 8;
+	size_t character_size = (max_font_size.height * row_size) + 128;
+	if (buffer_size + character_size > Buffer.size())
+	{
+		Flush();
+	}
+	char *output = Buffer.data() + buffer_size;
+	if (width_changed)
+	{
+		output = fmt::format_to(output, "current_font_width {}\n", current_font_width);
+	}
+	output = fmt::format_to(output, "draw on ; {}\n", index);
+	for (uint16_t y = 0; y < max_font_size.height; ++y)
+	{
+		const uint8_t *row = &Pixels[y * max_font_size.width];
+		if (pixel_digits == 1 && Settings.palette_format <= 3)
+		{
+			// Pixel values below 10 are their digit minus '0', so 8 of them are converted at once.  Both the pixels and the row have room to overrun.
+			for (uint16_t x = 0; x < draw_width; x += 8)
+			{
+				uint64_t digits;
+				memcpy(&digits, row + x, sizeof(digits));
+				digits |= 0x3030303030303030ull;
+				memcpy(output + x, &digits, sizeof(digits));
+			}
+			output += draw_width;
+		}
+		else if (pixel_digits == 1)
+		{
+			for (uint16_t x = 0; x < draw_width; ++x)
+			{
+				*output++ = PixelText[row[x]][0];
+			}
+		}
+		else
+		{
+			for (uint16_t x = 0; x < draw_width; ++x)
+			{
+				memcpy(output, PixelText[row[x]].data(), 8);
+				output += pixel_digits;
+			}
+		}
+		*output++ = '\n';
+	}
+	memcpy(output, "draw off\n\n", 10);
+	buffer_size = (output + 10) - Buffer.data();
+}
+
+void MisbitFontAssembler::SourceWriter::WriteString(std::string_view directive, std::string_view text)
+{
+	if (text.empty())
+	{
+		return;
+	}
+	// Strings cannot contain quotes or line breaks.
+	std::string representable(text);
+	representable.erase(std::remove_if(representable.begin(), representable.end(), [](char c) { return c == '"' || c == '\n' || c == '\r'; }), representable.end());
+	if (representable.size() != text.size())
+	{
+		++inexact_count;
+	}
+	Append(fmt::format("{} \"{}\"\n", directive, representable));
+}
+
+void MisbitFontAssembler::SourceWriter::Append(std::string_view text)
+{
+	if (buffer_size + text.size() > Buffer.size())
+	{
+		Flush();
+	}
+	memcpy(Buffer.data() + buffer_size, text.data(), text.size());
+	buffer_size += text.size();
+}
+
+void MisbitFontAssembler::SourceWriter::Flush()
+{
+	if (buffer_size > 0 && std::fwrite(Buffer.data(), 1, buffer_size, file) != buffer_size)
+	{
+		good = false;
+	}
+	buffer_size = 0;
+}
@@ -0,0 +1,118 @@
+#include "../include/statistics.hpp"
+#include "../include/diagnostics.hpp"
+#include "../include/allocation_counter.hpp"
+#include <chrono>
+#include <fmt/core.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MISBITFONT_ASSEMBLER_USE_TSC
+#include <x86intrin.h>
+#endif
+#if __has_include(<sys/resource.h>)
+#define MISBITFONT_ASSEMBLER_USE_RUSAGE
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	int64_t GetTime()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t GetTicks()
+	{
+#ifdef MISBITFONT_ASSEMBLER_USE_TSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(GetTime());
+#endif
+	}
+
+	// Per thread, so a batch job's count is not mixed with the jobs running next to it.
+	thread_local uint64_t thread_allocation_count = 0;
+
+	constexpr std::array<const char *, 7> PhaseNames = { "Other", "Input reading", "Tokenizing", "Pixel decoding", "Bit packing", "Header creation", "File writing" };
+}
+
+uint64_t MisbitFontAssembler::GetThreadAllocationCount()
+{
+	return thread_allocation_count;
+}
+
+void MisbitFontAssembler::CountThreadAllocation()
+{
+	++thread_allocation_count;
+}
+
+MisbitFontAssembler::Statistics::Statistics() : PhaseTicks {}, Counters {}, SavedPhaseTicks {}, SavedCounters {}, start_ticks(GetTicks()), last_ticks(start_ticks), start_time(GetTime()), current_phase(Phase::Other)
+{
+}
+
+MisbitFontAssembler::Phase MisbitFontAssembler::Statistics::Enter(Phase phase)
+{
+	uint64_t ticks = GetTicks();
+	PhaseTicks[static_cast<size_t>(current_phase)] += ticks - last_ticks;
+	last_ticks = ticks;
+	Phase previous_phase = current_phase;
+	current_phase = phase;
+	return previous_phase;
+}
+
+void MisbitFontAssembler::Statistics::Count(Counter counter, uint64_t amount)
+{
+	Counters[static_cast<size_t>(counter)] += amount;
+}
+
+void MisbitFontAssembler::Statistics::Save()
+{
+	Enter(current_phase);
+	SavedPhaseTicks = PhaseTicks;
+	SavedCounters = Counters;
+}
+
+void MisbitFontAssembler::Statistics::Restore()
+{
+	Enter(current_phase);
+	uint64_t discarded_ticks = 0;
+	for (size_t phase = 0; phase < PhaseTicks.size(); ++phase)
+	{
+		discarded_ticks += PhaseTicks[phase] - SavedPhaseTicks[phase];
+	}
+	PhaseTicks = SavedPhaseTicks;
+	PhaseTicks[static_cast<size_t>(Phase::Other)] += discarded_ticks;
+	// The allocations were still made, so they stay counted.
+	uint64_t worker_allocation_count = Counters[static_cast<size_t>(Counter::WorkerAllocations)];
+	Counters = SavedCounters;
+	Counters[static_cast<size_t>(Counter::WorkerAllocations)] = worker_allocation_count;
+}
+
+void MisbitFontAssembler::Statistics::Report(Diagnostics &JobDiagnostics, uint64_t allocation_count)
+{
+	Enter(Phase::Other);
+	double total_seconds = static_cast<double>(GetTime() - start_time) / 1e9;
+	uint64_t total_ticks = last_ticks - start_ticks;
+	double seconds_per_tick = total_ticks ? (total_seconds / static_cast<double>(total_ticks)) : 0.0;
+	JobDiagnostics.Message("Statistics:");
+	// Other comes last, after the phases it is the remainder of.
+	for (size_t p = 1; p <= PhaseTicks.size(); ++p)
+	{
+		size_t phase = p % PhaseTicks.size();
+		double seconds = static_cast<double>(PhaseTicks[phase]) * seconds_per_tick;
+		JobDiagnostics.Message(fmt::format("  {:<18}{:>12.6f} s {:>6.1f}%", PhaseNames[phase], seconds, total_seconds > 0.0 ? (seconds * 100.0) / total_seconds : 0.0));
+	}
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12.6f} s", "Total", total_seconds));
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Lines", Counters[static_cast<size_t>(Counter::Lines)]));
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Directives", Counters[static_cast<size_t>(Counter::Directives)]));
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Characters", Counters[static_cast<size_t>(Counter::Characters)]));
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Pixels", Counters[static_cast<size_t>(Counter::Pixels)]));
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Bytes written", Counters[static_cast<size_t>(Counter::BytesWritten)]));
+	// Allocations made by the worker threads decoding characters for this job are counted along with its own.
+	JobDiagnostics.Message(fmt::format("  {:<18}{:>12}", "Allocations", allocation_count + Counters[static_cast<size_t>(Counter::WorkerAllocations)]));
+#ifdef MISBITFONT_ASSEMBLER_USE_RUSAGE
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+		JobDiagnostics.Message(fmt::format("  {:<18}{:>12} KiB", "Peak RSS", usage.ru_maxrss));
+	}
+#endif
+}
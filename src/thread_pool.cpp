@@ -0,0 +1,133 @@
+#include "../include/thread_pool.hpp"
+#include <algorithm>
+#include <system_error>
+
+// A thread_count of 0 uses one thread per processor core.
+MisbitFontAssembler::ThreadPool::ThreadPool(size_t thread_count, size_t task_count) : queued_count(0), pending_count(0), next_queue(0), stopping(false), start_failed(false)
+{
+	if (thread_count == 0)
+	{
+		thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+	thread_count = std::clamp<size_t>(std::min(thread_count, task_count), 1, MaxThreadCount);
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		try
+		{
+			Workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+		}
+		catch (const std::system_error &)
+		{
+			// The threads already started are joined as usual by the destructor.
+			start_failed = true;
+			break;
+		}
+	}
+}
+
+MisbitFontAssembler::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> StateGuard(StateLock);
+		stopping = true;
+	}
+	WorkAvailable.notify_all();
+	for (auto &Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+void MisbitFontAssembler::ThreadPool::Submit(std::function<void()> &&Task)
+{
+	size_t index = 0;
+	{
+		std::lock_guard<std::mutex> StateGuard(StateLock);
+		index = next_queue++ % Queues.size();
+		++queued_count;
+		++pending_count;
+	}
+	{
+		std::lock_guard<std::mutex> QueueGuard(Queues[index]->Lock);
+		Queues[index]->Tasks.push_back(std::move(Task));
+	}
+	WorkAvailable.notify_one();
+}
+
+void MisbitFontAssembler::ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> StateGuard(StateLock);
+	WorkDone.wait(StateGuard, [this]() { return pending_count == 0; });
+}
+
+size_t MisbitFontAssembler::ThreadPool::GetThreadCount() const
+{
+	return Workers.size();
+}
+
+// Whether every thread was started, which has to be the case before submitting anything.
+bool MisbitFontAssembler::ThreadPool::HasStarted() const
+{
+	return !start_failed;
+}
+
+void MisbitFontAssembler::ThreadPool::WorkerLoop(size_t index)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> StateGuard(StateLock);
+			WorkAvailable.wait(StateGuard, [this]() { return stopping || queued_count > 0; });
+			if (queued_count == 0)
+			{
+				return;
+			}
+			--queued_count;
+		}
+		// A task has been reserved for this worker, so one of the queues is guaranteed to hold it.
+		std::function<void()> Task;
+		while (!TryTake(index, Task))
+		{
+			std::this_thread::yield();
+		}
+		Task();
+		{
+			std::lock_guard<std::mutex> StateGuard(StateLock);
+			--pending_count;
+			if (pending_count == 0)
+			{
+				WorkDone.notify_all();
+			}
+		}
+	}
+}
+
+bool MisbitFontAssembler::ThreadPool::TryTake(size_t index, std::function<void()> &Task)
+{
+	{
+		WorkerQueue &Own = *Queues[index];
+		std::lock_guard<std::mutex> QueueGuard(Own.Lock);
+		if (!Own.Tasks.empty())
+		{
+			Task = std::move(Own.Tasks.back());
+			Own.Tasks.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < Queues.size(); ++i)
+	{
+		WorkerQueue &Victim = *Queues[(index + i) % Queues.size()];
+		std::lock_guard<std::mutex> QueueGuard(Victim.Lock);
+		if (!Victim.Tasks.empty())
+		{
+			Task = std::move(Victim.Tasks.front());
+			Victim.Tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}